@@ -0,0 +1,2068 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2002, 2003, 2004, 2005, 2007,
+               2017, 2018, 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_aiplayer.hh"
+
+void skat_ai_player::announce
+	(const size_t spiel)
+{
+	switch (spiel % 100)
+	{
+		case 9:
+			*out << "CMD sagean Sc" << std::endl;
+			break;
+		case 10:
+			*out << "CMD sagean Ro" << std::endl;
+			break;
+		case 11:
+			*out << "CMD sagean Gr" << std::endl;
+			break;
+		case 12:
+			*out << "CMD sagean Ei" << std::endl;
+			break;
+		case 23:
+			if ((spiel % 1000) == 323)
+				*out << "CMD sagean Nu Ov" << std::endl;
+			else
+				*out << "CMD sagean Nu" << std::endl;
+			break;
+		case 24:
+			*out << "CMD sagean Gd" << std::endl;
+			break;
+	}
+}
+
+bool same_suit (const size_t c1, const size_t c2)
+{
+	for (size_t i = 0; i < 4; i++)
+	{
+		if ((c1 >= (4 + (i * 7))) && (c1 <= (10 + (i * 7))) &&
+			(c2 >= (4 + (i * 7))) && (c2 <= (10 + (i * 7))))
+		{
+			return true;
+		}
+		else if ((c1 == i) && (c2 >= (4 + (i * 7))) && (c2 <= (10 + (i * 7))))
+		{
+			return true;
+		}
+		else if ((c1 >= (4 + (i * 7))) && (c1 <= (10 + (i * 7))) && (c2 == i))
+		{
+			return true;
+		}
+	}
+	return false;
+} 
+
+bool jack (const size_t card)
+{
+	if ((card == 0) || (card == 1) || (card == 2) || (card == 3))
+		return true;
+	return false;
+}
+
+size_t jacks (const std::vector<size_t> &cards, std::vector<size_t> &jack_cards)
+{
+	jack_cards.clear();
+	for (size_t i = 0; i < cards.size(); i++)
+	{
+		if (jack(cards[i]))
+			jack_cards.push_back(cards[i]);
+	}
+	return jack_cards.size();
+}
+
+size_t num_jacks (const std::vector<size_t> &cards)
+{
+	std::vector<size_t> jc;
+	return jacks(cards, jc);
+}
+
+bool high_jacks (const std::vector<size_t> &cards)
+{
+	if (std::count(cards.begin(), cards.end(), (size_t)0) &&
+		std::count(cards.begin(), cards.end(), (size_t)1))
+	{
+		return true;
+	}
+	return false;
+}
+
+bool ace (size_t card)
+{
+	if ((card == 4) || (card == 11) || (card == 18) || (card == 25))
+		return true;
+	return false;
+}
+
+size_t aces (const std::vector<size_t> &cards, std::vector<size_t> &ace_cards)
+{
+	ace_cards.clear();
+	for (size_t i = 0; i < cards.size(); i++)
+	{
+		if (ace(cards[i]))
+			ace_cards.push_back(cards[i]);
+	}
+	return ace_cards.size();
+}
+
+size_t num_aces (const std::vector<size_t> &cards)
+{
+	std::vector<size_t> ac;
+	return aces(cards, ac);
+}
+
+bool ten (size_t card)
+{
+	if ((card == 5) || (card == 12) || (card == 19) || (card == 26))
+		return true;
+	return false;
+}
+
+size_t tens (const std::vector<size_t> &cards, std::vector<size_t> &ten_cards)
+{
+	ten_cards.clear();
+	for (size_t i = 0; i < cards.size(); i++)
+	{
+		if (ten(cards[i]))
+			ten_cards.push_back(cards[i]);
+	}
+	return ten_cards.size();
+}
+
+size_t num_tens (const std::vector<size_t> &cards)
+{
+	std::vector<size_t> tc;
+	return tens(cards, tc);
+}
+
+size_t suit (const size_t spiel, const std::vector<size_t> &cards,
+	std::vector<size_t> &suit_cards)
+{
+	suit_cards.clear();
+	switch (spiel % 100)
+	{
+		case 9:
+			for (size_t i = 25; i < 32; i++)
+			{
+				if (std::count(cards.begin(), cards.end(), i))
+					suit_cards.push_back(i);
+			}
+			break;
+		case 10:
+			for (size_t i = 18; i < 25; i++)
+			{
+				if (std::count(cards.begin(), cards.end(), i))
+					suit_cards.push_back(i);
+			}
+			break;
+		case 11:
+			for (size_t i = 11; i < 18; i++)
+			{
+				if (std::count(cards.begin(), cards.end(), i))
+					suit_cards.push_back(i);
+			}
+			break;
+		case 12:
+			for (size_t i = 4; i < 11; i++)
+			{
+				if (std::count(cards.begin(), cards.end(), i))
+					suit_cards.push_back(i);
+			}
+			break;
+	}
+	return suit_cards.size();
+}
+
+size_t num_suit (const size_t spiel, const std::vector<size_t> &cards)
+{
+	std::vector<size_t> sc;
+	return suit(spiel, cards, sc);
+}
+
+size_t trump (const size_t spiel, const std::vector<size_t> &cards,
+	std::vector<size_t> &trump_cards)
+{
+	std::vector<size_t> sc, jc;
+	trump_cards.clear();
+	if ((spiel % 100) == 23)
+		return 0;
+	if (jacks(cards, jc) > 0)
+		trump_cards.insert(trump_cards.end(), jc.begin(), jc.end());
+	if (suit(spiel, cards, sc) > 0)
+		trump_cards.insert(trump_cards.end(), sc.begin(), sc.end());
+	return trump_cards.size();
+}
+
+size_t num_trump (const size_t spiel, const std::vector<size_t> &cards)
+{
+	std::vector<size_t> tc;
+	return trump(spiel, cards, tc);
+}
+
+size_t high_suit (const size_t spiel, const std::vector<size_t> &cards,
+	std::vector<size_t> &high_cards)
+{
+	high_cards.clear();
+	if (std::count(cards.begin(), cards.end(), (size_t)4) &&
+		std::count(cards.begin(), cards.end(), (size_t)5) &&
+		std::count(cards.begin(), cards.end(), (size_t)6) && ((spiel % 100) != 12))
+	{
+		high_cards.push_back(4);
+		high_cards.push_back(5);
+	}
+	if (std::count(cards.begin(), cards.end(), (size_t)11) &&
+		std::count(cards.begin(), cards.end(), (size_t)12) &&
+		std::count(cards.begin(), cards.end(), (size_t)13) && ((spiel % 100) != 11))
+	{
+		high_cards.push_back(11);
+		high_cards.push_back(12);
+	}
+	if (std::count(cards.begin(), cards.end(), (size_t)18) &&
+		std::count(cards.begin(), cards.end(), (size_t)19) &&
+		std::count(cards.begin(), cards.end(), (size_t)20) && ((spiel % 100) != 10))
+	{
+		high_cards.push_back(18);
+		high_cards.push_back(19);
+	}
+	if (std::count(cards.begin(), cards.end(), (size_t)25) &&
+		std::count(cards.begin(), cards.end(), (size_t)26) &&
+		std::count(cards.begin(), cards.end(), (size_t)27) && ((spiel % 100) != 9))
+	{
+		high_cards.push_back(25);
+		high_cards.push_back(26);
+	}
+	return high_cards.size();
+}
+
+size_t good_suit (const std::vector<size_t> &cards)
+{
+	size_t gs = 0;
+	if (std::count(cards.begin(), cards.end(), (size_t)4) &&
+		std::count(cards.begin(), cards.end(), (size_t)5) &&
+		std::count(cards.begin(), cards.end(), (size_t)6))
+		gs++;
+	else if (std::count(cards.begin(), cards.end(), (size_t)4) &&
+		std::count(cards.begin(), cards.end(), (size_t)6) &&
+		(num_suit(12, cards) > 3))
+		gs++;
+	else if (std::count(cards.begin(), cards.end(), (size_t)5) &&
+		std::count(cards.begin(), cards.end(), (size_t)6) &&
+		(num_suit(12, cards) > 4))
+		gs++;
+	if (std::count(cards.begin(), cards.end(), (size_t)11) &&
+		std::count(cards.begin(), cards.end(), (size_t)12) &&
+		std::count(cards.begin(), cards.end(), (size_t)13))
+		gs++;
+	else if (std::count(cards.begin(), cards.end(), (size_t)11) &&
+		std::count(cards.begin(), cards.end(), (size_t)13) &&
+		(num_suit(11, cards) > 3))
+		gs++;
+	else if (std::count(cards.begin(), cards.end(), (size_t)12) &&
+		std::count(cards.begin(), cards.end(), (size_t)13) &&
+		(num_suit(11, cards) > 4))
+		gs++;
+	if (std::count(cards.begin(), cards.end(), (size_t)18) &&
+		std::count(cards.begin(), cards.end(), (size_t)19) &&
+		std::count(cards.begin(), cards.end(), (size_t)20))
+		gs++;
+	else if (std::count(cards.begin(), cards.end(), (size_t)18) &&
+		std::count(cards.begin(), cards.end(), (size_t)20) &&
+		(num_suit(10, cards) > 3))
+		gs++;
+	else if (std::count(cards.begin(), cards.end(), (size_t)19) &&
+		std::count(cards.begin(), cards.end(), (size_t)20) &&
+		(num_suit(10, cards) > 4))
+		gs++;
+	if (std::count(cards.begin(), cards.end(), (size_t)25) &&
+		std::count(cards.begin(), cards.end(), (size_t)26) &&
+		std::count(cards.begin(), cards.end(), (size_t)27))
+		gs++;
+	else if (std::count(cards.begin(), cards.end(), (size_t)25) &&
+		std::count(cards.begin(), cards.end(), (size_t)27) &&
+		(num_suit(9, cards) > 3))
+		gs++;
+	else if (std::count(cards.begin(), cards.end(), (size_t)26) &&
+		std::count(cards.begin(), cards.end(), (size_t)27) &&
+		(num_suit(9, cards) > 4))
+		gs++;
+	return gs;
+}
+
+bool low (size_t card)
+{
+	if ((card == 8) || (card == 9) || (card == 10) || (card == 15) || 
+		(card == 16) || (card == 17) || (card == 22) ||	(card == 23) ||
+		(card == 24) || (card == 29) || (card == 30) || (card == 31))
+	{
+		return true;
+	}
+	return false;
+}
+
+size_t lows (const std::vector<size_t> &cards, std::vector<size_t> &low_cards)
+{
+	low_cards.clear();
+	for (size_t i = 0; i < cards.size(); i++)
+	{
+		if (low(cards[i]))
+			low_cards.push_back(cards[i]);
+	}
+	return low_cards.size();
+}
+
+size_t num_lows (const std::vector<size_t> &cards)
+{
+	std::vector<size_t> lc;
+	return lows(cards, lc);
+}
+
+bool vlow (size_t card)
+{
+	if ((card == 9) || (card == 10) || (card == 16) || (card == 17) ||
+		(card == 23) || (card == 24) || (card == 30) || (card == 31))
+	{
+		return true;
+	}
+	return false;
+}
+
+size_t vlows (const std::vector<size_t> &cards, std::vector<size_t> &vlow_cards)
+{
+	vlow_cards.clear();
+	for (size_t i = 0; i < cards.size(); i++)
+	{
+		if (vlow(cards[i]))
+			vlow_cards.push_back(cards[i]);
+	}
+	return vlow_cards.size();
+}
+
+size_t num_vlows (const std::vector<size_t> &cards)
+{
+	std::vector<size_t> vlc;
+	return vlows(cards, vlc);
+}
+
+bool high (size_t card)
+{
+	if ((card == 4) || (card == 5) || (card == 11) || (card == 12) ||
+		(card == 18) || (card == 19) || (card == 25) || (card == 26))
+	{
+		return true;
+	}
+	return false;
+}
+
+size_t highs (const std::vector<size_t> &cards, std::vector<size_t> &high_cards)
+{
+	high_cards.clear();
+	for (size_t i = 0; i < cards.size(); i++)
+	{
+		if (high(cards[i]))
+			high_cards.push_back(cards[i]);
+	}
+	return high_cards.size();
+}
+
+size_t num_highs (const std::vector<size_t> &cards)
+{
+	std::vector<size_t> hc;
+	return highs(cards, hc);
+}
+
+bool trump (const size_t spiel, const size_t card)
+{
+	switch (spiel % 100)
+	{
+		case 9:
+			if (card < 4)
+				return true;
+			if ((card >= 25) && (card <= 31))
+				return true;
+			break;
+		case 10:
+			if (card < 4)
+				return true;
+			if ((card >= 18) && (card <= 24))
+				return true;
+			break;
+		case 11:
+			if (card < 4)
+				return true;
+			if ((card >= 11) && (card <= 17))
+				return true;
+			break;
+		case 12:
+			if (card < 4)
+				return true;
+			if ((card >= 4) && (card <= 10))
+				return true;
+			break;
+		case 23:
+			return false;
+		case 24:
+			if (card < 4)
+				return true;
+			break;
+	}
+	return false;
+}
+
+size_t eval (const std::vector<size_t> &cards, const bool starts,
+	size_t &sicher)
+{
+	size_t nj = num_jacks(cards);
+	bool hj = high_jacks(cards);
+	size_t na = num_aces(cards);
+	size_t nt = num_tens(cards);
+	size_t gs = good_suit(cards);
+	size_t nl = num_lows(cards);
+	size_t nv = num_vlows(cards);
+	// Null without risk: no card can be caught (after putting away two)
+	skat_cardset_t all = skat_vector2cardset(cards), cs = all;
+	if (cards.size() == 12)
+		cs &= ~skat_null_druecken(all, starts);
+	if (skat_null_sure(cs, ~all, starts, (cs == all) ? 2 : 0))
+	{
+		sicher = 100;
+		return 23;
+	}
+	// evaluate games based on a simple heuristic
+	if (starts)
+	{
+		// Grand
+		if (hj && (na > 2) && (nt > 2))
+		{
+			sicher = 100;
+			return 24;
+		}
+		if (hj && (gs > 1))
+		{
+			sicher = 100;
+			return 24;
+		}
+		if ((nj > 2) && (gs > 1))
+		{
+			sicher = 100;
+			return 24;
+		}
+		if ((nj > 3) && (gs > 0))
+		{
+			sicher = 75;
+			return 24;
+		}
+		if (hj && (gs > 0) && (na >= 2) && (nt >= 2))
+		{
+			sicher = 50;
+			return 24;
+		}
+		// Null
+		if ((nv > 7) || (nl > 8))
+		{
+			sicher = 50;
+			return 23;
+		}
+	}
+	else
+	{
+		// Grand
+		if ((nj > 2) && (na > 2) && (nt > 2))
+		{
+			sicher = 100;
+			return 24;
+		}
+		if ((nj > 2) && (gs > 1))
+		{
+			sicher = 100;
+			return 24;
+		}
+		if ((nj > 3) && (gs > 0))
+		{
+			sicher = 75;
+			return 24;
+		}
+		if ((nj > 2) && (gs > 0) && (na >= 2) && (nt >= 2))
+		{
+			sicher = 75;
+			return 24;
+		}
+		// Null
+		if ((nv > 6) || (nl > 7))
+		{
+			sicher = 50;
+			return 23;
+		}
+	}
+	// Suit
+	if ((num_trump(12, cards) > 6) ||
+		((num_trump(12, cards) > 5) && (na > 1)) ||
+		((num_trump(12, cards) > 4) && (na > 2)))
+	{
+		sicher = 25;
+		return 12;
+	}
+	if ((num_trump(11, cards) > 6) ||
+		((num_trump(11, cards) > 5) && (na > 1)) ||
+		((num_trump(11, cards) > 4) && (na > 2)))
+	{
+		sicher = 25;
+		return 11;
+	}
+	if ((num_trump(10, cards) > 6) ||
+		((num_trump(10, cards) > 5) && (na > 1)) ||
+		((num_trump(10, cards) > 4) && (na > 2)))
+	{
+		sicher = 25;
+		return 10;
+	}
+	if ((num_trump(9, cards) > 6) ||
+		((num_trump(9, cards) > 5) && (na > 1)) ||
+		((num_trump(9, cards) > 4) && (na > 2)))
+	{
+		sicher = 25;
+		return 9;
+	}
+	return 0;
+}
+
+size_t blank (const size_t spiel, const std::vector<size_t> &cards,
+	std::vector<size_t> &blank_cards)
+{
+	std::vector<size_t> sc;
+	blank_cards.clear();
+	switch (spiel % 100)
+	{
+		case 9:
+			if ((suit(10, cards, sc) == 1) && (sc[0] != 18))
+				blank_cards.push_back(sc[0]);
+			if ((suit(11, cards, sc) == 1) && (sc[0] != 11))
+				blank_cards.push_back(sc[0]);
+			if ((suit(12, cards, sc) == 1) && (sc[0] != 4))
+				blank_cards.push_back(sc[0]);
+			break;
+		case 10:
+			if ((suit(9, cards, sc) == 1) && (sc[0] != 25))
+				blank_cards.push_back(sc[0]);
+			if ((suit(11, cards, sc) == 1) && (sc[0] != 11))
+				blank_cards.push_back(sc[0]);
+			if ((suit(12, cards, sc) == 1) && (sc[0] != 4))
+				blank_cards.push_back(sc[0]);
+			break;
+		case 11:
+			if ((suit(9, cards, sc) == 1) && (sc[0] != 25))
+				blank_cards.push_back(sc[0]);
+			if ((suit(10, cards, sc) == 1) && (sc[0] != 18))
+				blank_cards.push_back(sc[0]);
+			if ((suit(12, cards, sc) == 1) && (sc[0] != 4))
+				blank_cards.push_back(sc[0]);
+			break;
+		case 12:
+			if ((suit(9, cards, sc) == 1) && (sc[0] != 25))
+				blank_cards.push_back(sc[0]);
+			if ((suit(10, cards, sc) == 1) && (sc[0] != 18))
+				blank_cards.push_back(sc[0]);
+			if ((suit(11, cards, sc) == 1) && (sc[0] != 11))
+				blank_cards.push_back(sc[0]);
+			break;
+		case 23:
+			if ((suit(9, cards, sc) == 1))
+				blank_cards.push_back(sc[0]);
+			if ((suit(10, cards, sc) == 1))
+				blank_cards.push_back(sc[0]);
+			if ((suit(11, cards, sc) == 1))
+				blank_cards.push_back(sc[0]);
+			if ((suit(12, cards, sc) == 1))
+				blank_cards.push_back(sc[0]);
+			break;
+		case 24:
+			if ((suit(9, cards, sc) == 1) && (sc[0] != 25))
+				blank_cards.push_back(sc[0]);
+			if ((suit(10, cards, sc) == 1) && (sc[0] != 18))
+				blank_cards.push_back(sc[0]);
+			if ((suit(11, cards, sc) == 1) && (sc[0] != 11))
+				blank_cards.push_back(sc[0]);
+			if ((suit(12, cards, sc) == 1) && (sc[0] != 4))
+				blank_cards.push_back(sc[0]);
+			break;
+	}
+	return blank_cards.size();
+}
+
+size_t rare (const size_t spiel, const std::vector<size_t> &cards,
+	std::vector<size_t> &rare_cards)
+{
+	std::vector<size_t> sc;
+	rare_cards.clear();
+	switch (spiel % 100)
+	{
+		case 9:
+			if ((suit(10, cards, sc) == 2) && (sc[0] != 18))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			if ((suit(11, cards, sc) == 2) && (sc[0] != 11))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			if ((suit(12, cards, sc) == 2) && (sc[0] != 4))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			break;
+		case 10:
+			if ((suit(9, cards, sc) == 2) && (sc[0] != 25))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			if ((suit(11, cards, sc) == 2) && (sc[0] != 11))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			if ((suit(12, cards, sc) == 2) && (sc[0] != 4))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			break;
+		case 11:
+			if ((suit(9, cards, sc) == 2) && (sc[0] != 25))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			if ((suit(10, cards, sc) == 2) && (sc[0] != 18))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			if ((suit(12, cards, sc) == 2) && (sc[0] != 4))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			break;
+		case 12:
+			if ((suit(9, cards, sc) == 2) && (sc[0] != 25))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			if ((suit(10, cards, sc) == 2) && (sc[0] != 18))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			if ((suit(11, cards, sc) == 2) && (sc[0] != 11))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			break;
+		case 24:
+			if ((suit(9, cards, sc) == 2) && (sc[0] != 25))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			if ((suit(10, cards, sc) == 2) && (sc[0] != 18))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			if ((suit(11, cards, sc) == 2) && (sc[0] != 11))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			if ((suit(12, cards, sc) == 2) && (sc[0] != 4))
+				rare_cards.push_back(sc[0]), rare_cards.push_back(sc[1]);
+			break;
+	}
+	return rare_cards.size();
+}
+
+size_t not_null (const std::vector<size_t> &cards,
+	std::vector<size_t> &bad_cards)
+{
+	bad_cards.clear();
+	if (cards.size() > 0)
+	{
+		for (size_t i = 0; i < 4; i++)
+		{
+			bool lowrow = false;
+			// 7, 8, 9
+			if (std::count(cards.begin(), cards.end(), (i * 7) + 6 + 4) &&
+				std::count(cards.begin(), cards.end(), (i * 7) + 5 + 4) &&
+				std::count(cards.begin(), cards.end(), (i * 7) + 4 + 4))
+			{
+				lowrow = true;
+			}
+			// 7, 8, 10
+			if (std::count(cards.begin(), cards.end(), (i * 7) + 6 + 4) &&
+				std::count(cards.begin(), cards.end(), (i * 7) + 5 + 4) &&
+				std::count(cards.begin(), cards.end(), (i * 7) + 1 + 4))
+			{
+				lowrow = true;
+			}
+			// 7, 8, U
+			if (std::count(cards.begin(), cards.end(), (i * 7) + 6 + 4) &&
+				std::count(cards.begin(), cards.end(), (i * 7) + 5 + 4) &&
+				std::count(cards.begin(), cards.end(), i))
+			{
+				lowrow = true;
+			}
+			// 7, 9, 10
+			if (std::count(cards.begin(), cards.end(), (i * 7) + 6 + 4) &&
+				std::count(cards.begin(), cards.end(), (i * 7) + 4 + 4) &&
+				std::count(cards.begin(), cards.end(), (i * 7) + 1 + 4))
+			{
+				lowrow = true;
+			}
+			if (!lowrow)
+			{
+				size_t fspiel = 12 - i; // betrachtete Farbe ohne Absicherung
+				std::vector<size_t> sc;
+				suit(fspiel, cards, sc);
+				for (size_t j = 0; j < sc.size(); j++)
+					bad_cards.push_back(sc[j]);
+			}
+		}
+	}
+	return bad_cards.size();
+}
+
+bool skat_ai_player::beyond
+	(const size_t base, const std::vector<size_t> &cards, size_t &result)
+{
+*dbg << "///// beyond() called" << std::endl;
+	if (base == 0)
+	{
+		return false;
+	}
+	else if (base == 1)
+	{
+		if (std::count(cards.begin(), cards.end(), (size_t)0))
+		{
+			result = 0;
+			return true;
+		}
+		else
+			return false;
+	}
+	else if (base == 2)
+	{
+		if (std::count(cards.begin(), cards.end(), (size_t)1))
+		{
+			result = 1;
+			return true;
+		}
+		else if (std::count(cards.begin(), cards.end(), (size_t)0))
+		{
+			result = 0;
+			return true;
+		}
+		else
+			return false;
+	}
+	else if (base == 3)
+	{
+		if (std::count(cards.begin(), cards.end(), (size_t)2))
+		{
+			result = 2;
+			return true;
+		}
+		else if (std::count(cards.begin(), cards.end(), (size_t)1))
+		{
+			result = 1;
+			return true;
+		}
+		else if (std::count(cards.begin(), cards.end(), (size_t)0))
+		{
+			result = 0;
+			return true;
+		}
+		else
+			return false;
+	}
+	else
+	{
+		for (size_t i = 0; i < 4; i++)
+		{
+			if ((base >= (4 + (i * 7))) && (base <= (10 + (i * 7))))
+			{
+				if (std::count(cards.begin(), cards.end(), (size_t)5 + (i * 7)))
+				{
+					// 10
+					if (5 + (i * 7) < base)
+					{
+						result = 5 + (i * 7);
+						return true;
+					}
+				}
+				if (std::count(cards.begin(), cards.end(), (size_t)7 + (i * 7)))
+				{
+					// O
+					if (7 + (i * 7) < base)
+					{
+						result = 7 + (i * 7);
+						return true;
+					}
+				}
+				if (std::count(cards.begin(), cards.end(), (size_t)6 + (i * 7)))
+				{
+					// K
+					if (6 + (i * 7) < base)
+					{
+						result = 6 + (i * 7);
+						return true;
+					}
+				}
+				if (std::count(cards.begin(), cards.end(), (size_t)4 + (i * 7)))
+				{
+					// A
+					if (4 + (i * 7) < base)
+					{
+						result = 4 + (i * 7);
+						return true;
+					}
+				}
+			}
+		}
+	}
+	return false;
+}
+
+bool skat_ai_player::below
+	(const size_t base, const std::vector<size_t> &cards, size_t &result)
+{
+*dbg << "///// below() called" << std::endl;
+	for (size_t i = 0; i < 4; i++)
+	{
+		if ((base >= (4 + (i * 7))) && (base <= (10 + (i * 7))))
+		{
+			// base == A
+			if (base == (4 + (i * 7)))
+			{
+				// K
+				if (std::count(cards.begin(), cards.end(), (size_t)6 + (i * 7)))
+				{
+					result = 6 + (i * 7);
+					return true;
+				}
+				// O
+				if (std::count(cards.begin(), cards.end(), (size_t)7 + (i * 7)))
+				{
+					result = 7 + (i * 7);
+					return true;
+				}
+				// U
+				if ((i == 0) && std::count(cards.begin(), cards.end(), (size_t)0))
+				{
+					result = 0;
+					return true;
+				}
+				if ((i == 1) && std::count(cards.begin(), cards.end(), (size_t)1))
+				{
+					result = 1;
+					return true;
+				}
+				if ((i == 2) && std::count(cards.begin(), cards.end(), (size_t)2))
+				{
+					result = 2;
+					return true;
+				}
+				if ((i == 3) && std::count(cards.begin(), cards.end(), (size_t)3))
+				{
+					result = 3;
+					return true;
+				}
+				// 10
+				if (std::count(cards.begin(), cards.end(), (size_t)5 + (i * 7)))
+				{
+					result = 5 + (i * 7);
+					return true;
+				}
+				// 9
+				if (std::count(cards.begin(), cards.end(), (size_t)8 + (i * 7)))
+				{
+					result = 8 + (i * 7);
+					return true;
+				}
+				// 8
+				if (std::count(cards.begin(), cards.end(), (size_t)9 + (i * 7)))
+				{
+					result = 9 + (i * 7);
+					return true;
+				}
+				// 7
+				if (std::count(cards.begin(), cards.end(), (size_t)10 + (i * 7)))
+				{
+					result = 10 + (i * 7);
+					return true;
+				}
+				return false;
+			}
+			// base == K
+			if (base == (6 + (i * 7)))
+			{
+				// O
+				if (std::count(cards.begin(), cards.end(), (size_t)7 + (i * 7)))
+				{
+					result = 7 + (i * 7);
+					return true;
+				}
+				// U
+				if ((i == 0) && std::count(cards.begin(), cards.end(), (size_t)0))
+				{
+					result = 0;
+					return true;
+				}
+				if ((i == 1) && std::count(cards.begin(), cards.end(), (size_t)1))
+				{
+					result = 1;
+					return true;
+				}
+				if ((i == 2) && std::count(cards.begin(), cards.end(), (size_t)2))
+				{
+					result = 2;
+					return true;
+				}
+				if ((i == 3) && std::count(cards.begin(), cards.end(), (size_t)3))
+				{
+					result = 3;
+					return true;
+				}
+				// 10
+				if (std::count(cards.begin(), cards.end(), (size_t)5 + (i * 7)))
+				{
+					result = 5 + (i * 7);
+					return true;
+				}
+				// 9
+				if (std::count(cards.begin(), cards.end(), (size_t)8 + (i * 7)))
+				{
+					result = 8 + (i * 7);
+					return true;
+				}
+				// 8
+				if (std::count(cards.begin(), cards.end(), (size_t)9 + (i * 7)))
+				{
+					result = 9 + (i * 7);
+					return true;
+				}
+				// 7
+				if (std::count(cards.begin(), cards.end(), (size_t)10 + (i * 7)))
+				{
+					result = 10 + (i * 7);
+					return true;
+				}
+				return false;
+			}
+			// base == O
+			if (base == (7 + (i * 7)))
+			{
+				// U
+				if ((i == 0) && std::count(cards.begin(), cards.end(), (size_t)0))
+				{
+					result = 0;
+					return true;
+				}
+				if ((i == 1) && std::count(cards.begin(), cards.end(), (size_t)1))
+				{
+					result = 1;
+					return true;
+				}
+				if ((i == 2) && std::count(cards.begin(), cards.end(), (size_t)2))
+				{
+					result = 2;
+					return true;
+				}
+				if ((i == 3) && std::count(cards.begin(), cards.end(), (size_t)3))
+				{
+					result = 3;
+					return true;
+				}
+				// 10
+				if (std::count(cards.begin(), cards.end(), (size_t)5 + (i * 7)))
+				{
+					result = 5 + (i * 7);
+					return true;
+				}
+				// 9
+				if (std::count(cards.begin(), cards.end(), (size_t)8 + (i * 7)))
+				{
+					result = 8 + (i * 7);
+					return true;
+				}
+				// 8
+				if (std::count(cards.begin(), cards.end(), (size_t)9 + (i * 7)))
+				{
+					result = 9 + (i * 7);
+					return true;
+				}
+				// 7
+				if (std::count(cards.begin(), cards.end(), (size_t)10 + (i * 7)))
+				{
+					result = 10 + (i * 7);
+					return true;
+				}
+				return false;
+			}
+			// base == 10
+			if (base == (5 + (i * 7)))
+			{
+				// 9
+				if (std::count(cards.begin(), cards.end(), (size_t)8 + (i * 7)))
+				{
+					result = 8 + (i * 7);
+					return true;
+				}
+				// 8
+				if (std::count(cards.begin(), cards.end(), (size_t)9 + (i * 7)))
+				{
+					result = 9 + (i * 7);
+					return true;
+				}
+				// 7
+				if (std::count(cards.begin(), cards.end(), (size_t)10 + (i * 7)))
+				{
+					result = 10 + (i * 7);
+					return true;
+				}
+				return false;
+			}
+			// base == 9
+			if (base == (8 + (i * 7)))
+			{
+				// 8
+				if (std::count(cards.begin(), cards.end(), (size_t)9 + (i * 7)))
+				{
+					result = 9 + (i * 7);
+					return true;
+				}
+				// 7
+				if (std::count(cards.begin(), cards.end(), (size_t)10 + (i * 7)))
+				{
+					result = 10 + (i * 7);
+					return true;
+				}
+				return false;
+			}
+			// base == 8
+			if (base == (9 + (i * 7)))
+			{
+				// 7
+				if (std::count(cards.begin(), cards.end(), (size_t)10 + (i * 7)))
+				{
+					result = 10 + (i * 7);
+					return true;
+				}
+				return false;
+			}
+		}
+		else if (base == i)
+		{
+			// 10
+			if (std::count(cards.begin(), cards.end(), (size_t)5 + (i * 7)))
+			{
+				result = 5 + (i * 7);
+				return true;
+			}
+			// 9
+			if (std::count(cards.begin(), cards.end(), (size_t)8 + (i * 7)))
+			{
+				result = 8 + (i * 7);
+				return true;
+			}
+			// 8
+			if (std::count(cards.begin(), cards.end(), (size_t)9 + (i * 7)))
+			{
+				result = 9 + (i * 7);
+				return true;
+			}
+			// 7
+			if (std::count(cards.begin(), cards.end(), (size_t)10 + (i * 7)))
+			{
+				result = 10 + (i * 7);
+				return true;
+			}
+			return false;
+		}
+	}
+	return false;
+}
+
+size_t value (const std::vector<size_t> &cards)
+{
+	size_t value = 0;
+	for (size_t i = 0; i < cards.size(); i++)
+		value += skat_pktwert[cards[i]];
+	return value;
+}
+
+
+skat_ai_player::skat_ai_player
+	(std::ostream &o, const unsigned long long seed, skat_pool &pool,
+	const std::string &engine, const unsigned long long bz,
+	const unsigned long long sz, skat_tt *tt):
+		skat_player(o, seed), dbg(&std::cerr), pkr_self(100), pkr_pos(100),
+		pkr_spielt(100), spiel(0), reiz_counter(0), biete(0), sicher(0),
+		pkt(0), opp_pkt(0), trumps(0), opp_trumps(0), reize_dran(false),
+		lege_dran(false), gepasst(false), handspiel(false), played_cards(0),
+		skat_cards(0), augen_spielt(0), pimc(NULL), ismcts(NULL),
+		evaluator(NULL), model(NULL), book(NULL), timer(NULL),
+		hand_plan(false), reiz_gesendet(false),
+		bedenkzeit(bz), spielzeit(sz)
+{
+	possible[0] = 0, possible[1] = 0, possible[2] = 0;
+	timer = new skat_timer(spielzeit);
+	if (engine == "ismcts")
+		ismcts = new skat_ismcts(pool);
+	else if (engine != "heuristik")
+	{
+		pimc = new skat_pimc(pool, tt);
+		pimc->samples = SKAT_PIMC_SAMPLES, pimc->exhaustive = SKAT_PIMC_WORLDS;
+		pimc->max_samples = SKAT_MORE_SAMPLES * SKAT_PIMC_SAMPLES;
+	}
+	if (engine != "heuristik")
+	{
+		evaluator = new skat_eval(pool, tt);
+		evaluator->samples = SKAT_EVAL_SAMPLES;
+		evaluator->max_samples = SKAT_MORE_SAMPLES * SKAT_EVAL_SAMPLES;
+	}
+	// das gelernte Modell bewertet die Spiele ohne Simulation (heuristik)
+	// bzw. verwirft aussichtslose Spiele vor der Simulation
+	if (skat_model_default().ready)
+		model = &skat_model_default();
+	if (evaluator != NULL)
+		evaluator->model = model;
+	// das Eroeffnungsbuch ersetzt beim Reizen die Simulation (haeufige Blaetter)
+	if ((model != NULL) && skat_book_default().ready())
+		book = &skat_book_default();
+}
+
+void skat_ai_player::debug
+	(std::ostream &o)
+{
+	dbg = &o;
+}
+
+// Frist fuer eine Entscheidung (die Suche liefert dann das bisher Beste)
+unsigned long long skat_ai_player::deadline
+	(const size_t phase, const size_t decisions,
+	const size_t weight)
+{
+	if ((bedenkzeit > 0) || (timer == NULL))
+		return skat_msec() + ((bedenkzeit > 0) ? bedenkzeit : 1000);
+	return timer->start(phase, decisions, weight);
+}
+
+void skat_ai_player::deadline_done
+	()
+{
+	if (timer != NULL)
+		timer->stop();
+}
+
+// Spielauswahl durch Simulation: das Spiel mit dem besten Erwartungswert
+// der Spielliste, wobei mindestens min_wert erreicht werden muss; ohne
+// must wird nur ein Spiel mit positivem Erwartungswert gewaehlt
+size_t skat_ai_player::choose
+	(const std::vector<size_t> &cards, const size_t min_wert,
+	const bool must, size_t &wert, size_t &sicher, bool &hand)
+{
+	std::vector<skat_bid> bids;
+	// beim Reizen eine Entscheidung, nach Aufnahme des Skats zwei
+	if ((cards.size() == 10) && (book != NULL) &&
+		book->evaluate(skat_vector2cardset(cards), pkr_pos, min_wert, *model,
+		bids))
+	{
+*dbg << "///// eval: Eroeffnungsbuch" << std::endl;
+	}
+	else if (evaluator == NULL)
+		model->evaluate(skat_vector2cardset(cards), pkr_pos, min_wert, bids);
+	else
+	{
+		if (cards.size() == 12)
+			evaluator->evaluate(skat_vector2cardset(cards), pkr_pos, min_wert,
+				deadline(SKAT_TIMER_DRUECKEN, 2, 1), bids);
+		else
+			evaluator->evaluate(skat_vector2cardset(cards), pkr_pos, min_wert,
+				deadline(SKAT_TIMER_REIZEN, 1, 1), bids);
+		deadline_done();
+	}
+	// Null Ouvert, wenn keine Karte gefangen werden kann (Analyse der Reihen)
+	skat_cardset_t cs = skat_vector2cardset(cards);
+	skat_bid nb;
+	nb.spiel = 323, nb.hand = (cards.size() != 12), nb.win = 1.0;
+	nb.wert = skat_eval_wert(nb.spiel, nb.hand, cs), nb.samples = 1;
+	nb.score = skat_eval_score(nb.win, nb.wert);
+	if (nb.wert >= min_wert)
+	{
+		if (nb.hand && skat_null_sure(cs, ~cs, (pkr_pos == 0), 2))
+			bids.push_back(nb);
+		else if (!nb.hand && skat_null_sure(cs & ~skat_null_druecken(cs,
+			(pkr_pos == 0)), ~cs, (pkr_pos == 0), 0))
+		{
+			bids.push_back(nb);
+		}
+	}
+	size_t best = bids.size();
+	for (size_t i = 0; i < bids.size(); i++)
+	{
+*dbg << "///// eval spiel = " << bids[i].spiel << " hand = " << bids[i].hand << " win = " << bids[i].win << " score = " << bids[i].score << " wert = " << bids[i].wert << " samples = " << bids[i].samples << std::endl;
+		if (bids[i].samples == 0)
+			continue;
+		if (!must && (bids[i].score <= 0.0))
+			continue;
+		if ((best == bids.size()) || (bids[i].score > bids[best].score))
+			best = i;
+	}
+	if (best == bids.size())
+		return 0;
+	wert = bids[best].wert, hand = bids[best].hand;
+	sicher = (size_t)(100 * bids[best].win);
+	return bids[best].spiel;
+}
+
+// Karte card ist bekannt und kann nur noch beim Spieler p liegen
+void skat_ai_player::card_known
+	(const size_t card, const size_t p)
+{
+	for (size_t i = 0; i < 3; i++)
+	{
+		if (i != p)
+			possible[i] &= ~skat_card2set(card);
+	}
+}
+
+// maximale Anzahl der Truempfe beim Gegner (bzw. bei den Gegnern)
+void skat_ai_player::update_opp_trumps
+	()
+{
+	skat_cardset_t opp = 0;
+	if ((pkr_self > 2) || (pkr_spielt > 2))
+		return;
+	for (size_t i = 0; i < 3; i++)
+	{
+		if ((i != pkr_self) && ((pkr_self == pkr_spielt) || (i == pkr_spielt)))
+			opp |= possible[i];
+	}
+	opp_trumps = skat_cardset_size(opp & skat_trumpmask(spiel));
+}
+
+void skat_ai_player::process_command
+	(size_t &readed, char *buffer)
+{
+	skat_ctl_message msg;
+	if (readed == 0)
+		return;
+	// process each complete line (tokens in place)
+	while (parser.next(buffer, readed, msg))
+	{
+	    const skat_ctl_token *par = msg.argv;
+	    if (msg.argc < 2)
+			continue;
+		size_t from = 100;
+		for (size_t j = 0; j < nicks.size(); j++)
+		{
+		    if (par[0] == nicks[j])
+				from = j;
+		}
+		if ((par[1] == "INIT") && (msg.argc >= 4) && (nicks.size() < 3))
+		{
+		    if (par[2] == par[0])
+				pkr_self = nicks.size();
+		    nicks.push_back(par[2].s);
+		    std::string name;
+		    for (size_t j = 0; j < (msg.argc - 3); j++)
+		    {
+				name += par[3 + j].s;
+				if (j < (msg.argc - 4))
+				    name += " ";
+		    }
+		    names.push_back(name);
+		}
+		if ((par[1] == "DONE") && (msg.argc == 2) && (from == pkr_self))
+		{
+			// nothing to do
+		}
+		if ((par[1] == "MISCHEN") && (msg.argc == 2) && (from == pkr_self))
+		{
+			// nothing to do
+		}
+		if ((par[1] == "GEBEN") && (msg.argc == 2) && (from == pkr_self))
+		{
+			// nothing to do
+		}
+		if ((par[1] == "KARTE") && (msg.argc == 3) && (from == pkr_self))
+		{
+			cards.push_back(atoi(par[2].s));
+			if (pkr_self < 3)
+			{
+				possible[pkr_self] |= skat_card2set(cards.back());
+				card_known(cards.back(), pkr_self);
+			}
+		}
+		if ((par[1] == "START") && (msg.argc == 3) && (from == pkr_self))
+		{
+		    pkr_pos = atoi(par[2].s);
+		    reize_dran = (pkr_pos == 1) ? true : false;
+			reiz_gesendet = false;
+			for (size_t i = 0; i < 3; i++)
+				possible[i] = ~skat_vector2cardset(cards);
+			if (pkr_self < 3)
+				possible[pkr_self] = skat_vector2cardset(cards);
+			reiz_counter = 0, spiel = 0, sicher = 0;
+			pkt = 0, opp_pkt = 0, trumps = 0, opp_trumps = 0;
+			handspiel = false, hand_plan = false;
+			if (timer != NULL)
+				timer->reset(spielzeit);
+			if ((evaluator != NULL) || (model != NULL))
+				spiel = choose(cards, 0, false, biete, sicher, hand_plan);
+			else if ((spiel = eval(cards, !pkr_pos, sicher)))
+			{
+				size_t sp = skat_spitzen(24, cards); // nur Buben als Spitze
+				biete = ((sp + 1) * (spiel % 100));
+			}
+		}
+		if ((par[1] == "BEDENKZEIT") && (msg.argc == 3))
+		{
+			// Zeit (in ms) fuer jede Entscheidung, 0 = Voreinstellungen
+			bedenkzeit = strtoul(par[2].s, NULL, 10);
+		}
+		if ((par[1] == "SPIELZEIT") && (msg.argc == 3))
+		{
+			// Zeit (in ms) fuer ein ganzes Spiel (ab dem naechsten Spiel)
+			spielzeit = strtoul(par[2].s, NULL, 10);
+		}
+		if ((par[1] == "RAMSCH") && (msg.argc == 2) && (from == pkr_self))
+		{
+			// nothing to do
+		}
+		if ((par[1] == "SPIELT") && (msg.argc == 2) && (pkr_self != 100))
+		{
+			if (par[0] == nicks[0])
+				pkr_spielt = 0;
+			else if (par[0] == nicks[1])
+				pkr_spielt = 1;
+			else if (par[0] == nicks[2])
+				pkr_spielt = 2;
+			if (pkr_spielt == pkr_self)
+			{
+				if ((evaluator != NULL) || (model != NULL))
+				{
+					if (hand_plan)
+						*out << "CMD hand" << std::endl << std::flush;
+					else
+						*out << "CMD skat" << std::endl << std::flush;
+				}
+				else if ((spiel % 100) == 23)
+				{
+					std::vector<size_t> nn, bc;
+					skat_cardset_t cs = skat_vector2cardset(cards);
+					not_null(cards, nn);
+					blank(spiel, cards, bc);
+*dbg << "///// hand? nn = " << nn.size() << " bc = " << bc.size() << std::endl;
+					if (skat_null_sure(cs, ~cs, (pkr_pos == 0), 2))
+						*out << "CMD hand" << std::endl << std::flush;
+					else if ((nn.size() > 0) || (bc.size() > 1))
+						*out << "CMD skat" << std::endl << std::flush;
+					else
+						*out << "CMD hand" << std::endl << std::flush;
+				}
+				else
+				{
+					std::vector<size_t> bc, tc, bt(4), rc;
+					std::vector<size_t>::iterator it;
+					blank(spiel, cards, bc);
+					std::sort(bc.begin(), bc.end());
+					tens(cards, tc);
+					std::sort(tc.begin(), tc.end());
+					it = std::set_intersection(bc.begin(), bc.end(),
+						tc.begin(), tc.end(), bt.begin());
+					bt.resize(it - bt.begin());
+					rare(spiel, cards, rc);
+*dbg << "///// hand? bt = " << bt.size() << " bc = " << bc.size() << " rc = " << rc.size() << std::endl;
+					if ((bt.size() > 0) || (bc.size() > 1) || (rc.size() == 2))
+						*out << "CMD skat" << std::endl << std::flush;
+					else
+						*out << "CMD hand" << std::endl << std::flush;
+				}
+			}
+		}
+		if ((par[1] == "PASSE") && (msg.argc == 2))
+		{
+			if (from == pkr_self)
+				gepasst = true;
+			reize_dran = (!gepasst) ? true : false;
+			reiz_gesendet = false;
+		}
+		if ((par[1] == "REIZE") && (msg.argc == 3))
+		{
+			reiz_counter++, reiz_gesendet = false;
+			if (from == pkr_self)
+				reize_dran = false;
+			else 
+				reize_dran = (!gepasst) ? true : false;
+		}
+		if ((par[1] == "HAND") && (msg.argc == 2) && (from == pkr_spielt))
+		{
+			reize_dran = false;
+			handspiel = true;
+			if ((from == pkr_spielt) && (pkr_spielt == pkr_self))
+			{
+				announce(spiel);
+			}
+		}
+		if ((par[1] == "SKAT") && (msg.argc == 2) && (from == pkr_spielt))
+		{
+			reize_dran = false;
+			if ((from == pkr_spielt) && (pkr_spielt == pkr_self))
+			{
+				size_t sicher2 = 0, wert2 = 0;
+				bool hand2 = false;
+				if ((evaluator != NULL) || (model != NULL))
+				{
+					// Neubewertung mit den Karten aus dem Skat
+					size_t spiel2 = choose(cards, skat_reizwert[reiz_counter],
+						true, wert2, sicher2, hand2);
+					if (spiel2)
+						spiel = spiel2, sicher = sicher2;
+				}
+				else
+				{
+					size_t spiel2 = eval(cards, !pkr_pos, sicher2);
+					if (spiel2 > spiel)
+					{
+						if (sicher2 >= sicher)
+							spiel = spiel2, sicher = sicher2;
+					}
+					else if (sicher2 > sicher)
+					{
+						size_t sp = skat_spitzen(24, cards); // nur Buben als Spitze
+						size_t biete2 = ((sp + 1) * (spiel2 % 100));
+						if ((biete2 > biete) || (biete2 >= skat_reizwert[reiz_counter]))
+							spiel = spiel2, sicher = sicher2;
+					}
+				}
+				size_t c0 = cards[0], c1 = cards[1]; // fallback: first 2 cards
+				skat_cardset_t cs = skat_vector2cardset(cards);
+				skat_cardset_t nd = skat_null_druecken(cs, (pkr_pos == 0));
+				if (((spiel % 100) == 23) && (nd != 0) &&
+					(skat_null_sure(cs & ~nd, ~cs, (pkr_pos == 0), 0) ||
+					((evaluator == NULL) && (model == NULL))))
+				{
+					// Nullspiel: moeglichst keine Karte, die gefangen werden kann
+					std::vector<size_t> dc;
+					skat_cardset2vector(nd, dc);
+					c0 = dc[0], c1 = dc[1];
+				}
+				else if (evaluator != NULL)
+				{
+					// alle 66 Moeglichkeiten zu druecken (ohne dominierte)
+					std::vector<size_t> dc;
+					skat_cardset2vector(evaluator->druecken(
+						skat_vector2cardset(cards), spiel, pkr_pos,
+						deadline(SKAT_TIMER_DRUECKEN, 1, 1)), dc);
+					deadline_done();
+*dbg << "///// druecken = " << dc.size() << std::endl;
+					if (dc.size() == 2)
+						c0 = dc[0], c1 = dc[1];
+				}
+				else if (model != NULL)
+				{
+					std::vector<size_t> dc;
+					skat_cardset2vector(skat_eval_druecken(spiel,
+						skat_vector2cardset(cards)), dc);
+					if (dc.size() == 2)
+						c0 = dc[0], c1 = dc[1];
+				}
+				else
+				{
+					std::vector<size_t> hs, bc, tc, bt(4), rc;
+					std::vector<size_t>::iterator it;
+					high_suit(spiel, cards, hs);
+					blank(spiel, cards, bc);
+					std::sort(bc.begin(), bc.end());
+					tens(cards, tc);
+					std::sort(tc.begin(), tc.end());
+					it = std::set_intersection(bc.begin(), bc.end(),
+						tc.begin(), tc.end(), bt.begin());
+					bt.resize(it - bt.begin());
+					for (size_t i = 0; i < bt.size(); i++)
+					{
+						// Entferne blanke Zehnen aus Menge bc (Doppelungen)
+						if (std::count(bc.begin(), bc.end(), bt[i]))
+						{
+							bc.erase(std::remove(bc.begin(), bc.end(), bt[i]),
+								bc.end());
+						}
+					}
+					rare(spiel, cards, rc);
+*dbg << "///// bt = " << bt.size() << " bc = " << bc.size() << " hs = " << hs.size() << " rc = " << rc.size() << std::endl;
+					if (bt.size() >= 2)
+					{
+						// mindestens zwei blanke Zehnen
+						size_t idx1 = rnd() % bt.size();
+						c0 = bt[idx1];
+						bt.erase(std::remove(bt.begin(), bt.end(), c0),
+							bt.end());
+						size_t idx2 = rnd() % bt.size();
+						c1 = bt[idx2];
+					}
+					else if ((bt.size() == 1) && (bc.size() > 0))
+					{
+						// eine blanke Zehn und weitere blanke Karten
+						c0 = bt[0];
+						bt.erase(std::remove(bt.begin(), bt.end(), c0),
+							bt.end());
+						size_t idx2 = rnd() % bc.size();
+						c1 = bc[idx2];
+					}
+					else if ((bt.size() == 1) && (bc.size() == 0))
+					{
+						// eine blanke Zehn und keine weiteren blanken Karten
+						c0 = bt[0];
+						bt.erase(std::remove(bt.begin(), bt.end(), c0),
+							bt.end());
+						// zufällige Karte (kein Trumpf, kein Ass druecken)
+						while (trump(spiel, c1) || ace(c1) || (c0 == c1))
+						{
+							size_t j = rnd() % cards.size();
+							c1 = cards[j];
+						}
+					}
+					else if ((bt.size() == 0) && (bc.size() >= 2))
+					{
+						// keine blanke Zehn aber mind. zwei blanke Karten
+						size_t idx1 = rnd() % bc.size();
+						c0 = bc[idx1];
+						bc.erase(std::remove(bc.begin(), bc.end(), c0),
+							bc.end());
+						size_t idx2 = rnd() % bc.size();
+						c1 = bc[idx2];
+					}
+					else if (rc.size() >= 2)
+					{
+						// blanke Farbe entfernen (TODO: random, if rc > 2)
+						c0 = rc[0], c1 = rc[1];
+					}
+					else if (hs.size() > 3)
+					{
+						// Asse und/oder Zehnen bunkern
+						size_t idx1 = rnd() % hs.size();
+						c0 = hs[idx1];
+						hs.erase(std::remove(hs.begin(), hs.end(), c0),
+							hs.end());
+						size_t idx2 = rnd() % hs.size();
+						c1 = hs[idx2];
+					}
+					else
+					{
+						// zufällige Karte (kein Trumpf, kein Ass druecken)
+						while (trump(spiel, c0) || ace(c0) ||
+							trump(spiel, c1) || ace(c1) || (c0 == c1))
+						{
+							size_t i = rnd() % cards.size();
+							size_t j = rnd() % cards.size();
+							c0 = cards[i], c1 = cards[j];
+						}
+					}
+				}
+				pkt += skat_pktwert[c0];
+				pkt += skat_pktwert[c1];
+				skat_cards = skat_card2set(c0) | skat_card2set(c1);
+				if (pkr_self < 3)
+					possible[pkr_self] &= ~skat_cards;
+				std::string card0 = skat_type2string(c0);
+				std::string card1 = skat_type2string(c1);
+				cards.erase(std::remove(cards.begin(), cards.end(), c0),
+					cards.end());
+				cards.erase(std::remove(cards.begin(), cards.end(), c1),
+					cards.end());
+				*out << "CMD druecke " << 
+					card0.substr(0, card0.length() - 1) << " " << 
+					card1.substr(0, card1.length() - 1) << std::endl <<
+					std::flush;
+			}
+		}
+		if ((par[1] == "DRUECKE") && (msg.argc == 2) && (from == pkr_spielt))
+		{
+			if ((from == pkr_spielt) && (pkr_spielt == pkr_self))
+			{
+				announce(spiel);
+			}
+		}
+		if ((par[1] == "SAGEAN") && (msg.argc == 3) && (from == pkr_spielt))
+		{
+			spiel = atoi(par[2].s);
+			trumps = num_trump(spiel, cards);
+			update_opp_trumps(); // calculate maximum opponent trumps
+			lege_dran = (pkr_pos == 0) ? true : false;
+		}
+		if ((par[1] == "OUVERT") && (msg.argc == 3) && (from == pkr_spielt))
+		{
+			ocards.push_back(atoi(par[2].s));
+			if (pkr_spielt < 3)
+			{
+				possible[pkr_spielt] = skat_vector2cardset(ocards);
+				card_known(ocards.back(), pkr_spielt);
+			}
+			if (pkr_self != pkr_spielt)
+				opp_trumps = num_trump(spiel, ocards);
+		}
+		if ((par[1] == "LEGE") && (msg.argc == 3))
+		{
+			size_t card = atoi(par[2].s);
+			stich.push_back(card), nick_stich.push_back(par[0].s);
+			played_cards |= skat_card2set(card);
+			lege_dran = ((stich.size() < 3) && 
+				(((from + 1) % 3) == pkr_self)) ? true : false;
+			// remove played card from my hand
+			if (par[0] == nicks[pkr_self])
+			{
+				cards.erase(std::remove(cards.begin(), cards.end(), card),
+					cards.end());
+   			}
+			// remove played ouvert card from stack
+			if ((par[0] == nicks[pkr_spielt]) && (ocards.size() > 0))
+			{
+				ocards.erase(std::remove(ocards.begin(), ocards.end(),
+					card), ocards.end());
+			}
+			// update card model: played card and missing suit (Fehlfarbe)
+			card_known(card, 3);
+			if ((from < 3) && (stich.size() > 1) &&
+				!(skat_suitmask(spiel, stich[0]) & skat_card2set(card)))
+			{
+				possible[from] &= ~skat_suitmask(spiel, stich[0]);
+			}
+			// update trump statistics
+			if (par[0] == nicks[pkr_self])
+				trumps = num_trump(spiel, cards);
+			update_opp_trumps();
+		}
+		if ((par[1] == "BSTICH") && (msg.argc == 2))
+		{
+			// update point statistics
+			if (from == pkr_spielt)
+				augen_spielt += skat_augen(skat_vector2cardset(stich));
+			if (par[0] == nicks[pkr_self])
+			{
+				lege_dran = true;
+				for (size_t i = 0; i < stich.size(); i++)
+					pkt += skat_pktwert[stich[i]];
+			}
+			else
+			{
+				lege_dran = false;
+				if (pkr_spielt == pkr_self)
+				{
+					for (size_t i = 0; i < stich.size(); i++)
+						opp_pkt += skat_pktwert[stich[i]];
+				}
+				else if (par[0] == nicks[pkr_spielt])
+				{
+					for (size_t i = 0; i < stich.size(); i++)
+						opp_pkt += skat_pktwert[stich[i]];
+				}
+				else
+				{
+					for (size_t i = 0; i < stich.size(); i++)
+						pkt += skat_pktwert[stich[i]];
+				}
+			}
+			stich.clear(), nick_stich.clear();
+		}
+		if ((par[1] == "STOP") && (msg.argc == 2) && (from == pkr_self))
+		{
+			cards.clear(), ocards.clear(), stich.clear(), nick_stich.clear();
+			played_cards = 0, skat_cards = 0, augen_spielt = 0;
+			possible[0] = 0, possible[1] = 0, possible[2] = 0;
+			pkr_pos = 100, pkr_spielt = 100, biete = 0, spiel = 0;
+			reize_dran = false, lege_dran = false, gepasst = false;
+			reiz_gesendet = false;
+		}
+		if ((par[1] == "GEWONNEN") && (msg.argc == 2))
+		{
+			// nothing to do
+		}
+		if ((par[1] == "VERLOREN") && (msg.argc == 2))
+		{
+			// nothing to do
+		}
+		if ((par[1] == "PROTO") && (msg.argc == 3))
+		{
+			// nothing to do
+		}
+	} // end 2nd while
+	parser.consume(buffer, readed);
+}
+
+size_t skat_ai_player::seat
+	(const std::string &nick)
+{
+	for (size_t j = 0; j < nicks.size(); j++)
+	{
+		if (nick == nicks[j])
+			return j;
+	}
+	return 100;
+}
+
+// Informationsmenge: was ist ueber die Verteilung der Karten bekannt?
+bool skat_ai_player::infoset
+	(skat_infoset &is)
+{
+	if ((cards.size() == 0) || (pkr_self > 2) || (pkr_spielt > 2) ||
+		(nicks.size() != 3) || (skat_spiel2gwert(spiel) == 0))
+	{
+		return false;
+	}
+	size_t lead = (stich.size() > 0) ? seat(nick_stich[0]) : pkr_self;
+	if (lead > 2)
+		return false;
+	is.spiel = spiel, is.declarer = pkr_spielt, is.self = pkr_self;
+	is.lead = lead;
+	for (size_t i = 0; i < 3; i++)
+		is.hand[i] = 0, is.trick[i] = (i < stich.size()) ? stich[i] : 99;
+	is.trick_len = stich.size();
+	is.augen = augen_spielt + skat_augen(skat_cards);
+	is.hand[pkr_self] = skat_vector2cardset(cards);
+	// bekannte Karten: eigene, gespielte, gedrueckte und offene Karten
+	skat_cardset_t known = is.hand[pkr_self] | played_cards | skat_cards;
+	bool known_hand[3] = { false, false, false };
+	known_hand[pkr_self] = true;
+	if ((pkr_self != pkr_spielt) && (ocards.size() > 0))
+	{
+		is.hand[pkr_spielt] = skat_vector2cardset(ocards);
+		known |= is.hand[pkr_spielt];
+		known_hand[pkr_spielt] = true;
+	}
+	is.unknown = ~known;
+	is.count[3] = (skat_cards) ? 0 : 2;
+	is.possible[3] = is.unknown;
+	size_t total = is.count[3];
+	for (size_t i = 0; i < 3; i++)
+	{
+		// Spieler, die im aktuellen Stich schon gelegt haben
+		size_t n = cards.size();
+		for (size_t j = 0; j < stich.size(); j++)
+		{
+			if (((lead + j) % 3) == i)
+				n--;
+		}
+		is.count[i] = 0, is.possible[i] = 0;
+		if (!known_hand[i])
+		{
+			is.count[i] = n, is.possible[i] = possible[i] & is.unknown;
+			total += n;
+		}
+		else if (skat_cardset_size(is.hand[i]) != n)
+			return false;
+	}
+	if (total != skat_cardset_size(is.unknown))
+		return false;
+	return true;
+}
+
+// Kartenspiel: Perfect Information Monte Carlo (bzw. vollstaendige
+// Aufzaehlung aller Verteilungen in den letzten Stichen) oder Information
+// Set Monte Carlo Tree Search, je nach gewaehlter Engine
+bool skat_ai_player::search
+	(size_t &result)
+{
+	skat_infoset is;
+	if (((pimc == NULL) && (ismcts == NULL)) || !infoset(is))
+		return false;
+	std::vector<size_t> mv, score;
+	// mehr Zeit fuer kritische Stiche: viele erlaubte Karten (aber noch
+	// keine vollstaendige Aufzaehlung) oder viele Augen im Stich
+	size_t t = (is.trick_len > 0) ? is.trick[0] : 99, weight = 1;
+	size_t n = skat_cardset_size(skat_legal(t, is.spiel, is.hand[is.self]));
+	size_t exact = (pimc != NULL) ? pimc->exact_cards : 0;
+	if ((n >= 3) && (cards.size() > exact))
+		weight++;
+	if (value(stich) >= 10)
+		weight++;
+	if (n < 2)
+		weight = 0;
+	unsigned long long d = deadline(SKAT_TIMER_STICHE, cards.size(), weight);
+	if (ismcts != NULL)
+	{
+		ismcts->decide(is, d, mv, score);
+		deadline_done();
+*dbg << "///// ismcts moves = " << mv.size() << " iterations = " << ismcts->iterations << std::endl;
+		if ((mv.size() == 0) || ((mv.size() > 1) && (ismcts->iterations == 0)))
+			return false;
+	}
+	else
+	{
+		pimc->decide(is, d, mv, score);
+		deadline_done();
+*dbg << "///// search moves = " << mv.size() << " worlds = " << pimc->worlds << " nodes = " << pimc->nodes << std::endl;
+*dbg << "///// tt probes = " << pimc->tt_probes << " hits = " << pimc->tt_hits << " misses = " << (pimc->tt_probes - pimc->tt_hits - pimc->tt_collisions) << " collisions = " << pimc->tt_collisions << " overwrites = " << pimc->tt_overwrites << " tablebase = " << pimc->tb_hits << std::endl;
+		if ((mv.size() == 0) || ((mv.size() > 1) && (pimc->worlds == 0)))
+			return false;
+	}
+	size_t best = 0;
+	for (size_t i = 1; i < score.size(); i++)
+	{
+		if (score[i] > score[best])
+			best = i;
+	}
+	result = mv[best];
+	return true;
+}
+
+// reagiert auf den aktuellen Zustand; ein Gebot wird nur einmal gesendet,
+// ausser bei einer Wiederholung (retry) ohne Antwort des Spiels
+void skat_ai_player::act
+	(const bool retry)
+{
+	if (reize_dran)
+	{
+		if (reiz_gesendet && !retry)
+			return;
+		reiz_gesendet = true;
+*dbg << "///// spiel = " << spiel << " biete = " << biete << std::endl;
+		if (spiel && (biete > skat_reizwert[reiz_counter]))
+			*out << "CMD reize" << std::endl << std::flush;
+		else
+			*out << "CMD passe" << std::endl << std::flush;
+	}
+	else if (lege_dran)
+	{
+*dbg << "///// spiel = " << spiel << " trumps = " << trumps << " opp_trumps = " << opp_trumps << " pkt = " << pkt << " opp_pkt = " << opp_pkt << std::endl;
+*dbg << "///// stich.size() = " << stich.size() << " value = " << value(stich) << std::endl;
+		assert((cards.size() > 0));
+		lege_dran = false;
+		size_t ec, nc = 99;
+		skat_infoset is;
+		bool null = (((spiel % 100) == 23) && infoset(is));
+		if (null && skat_null_play(is, nc))
+		{
+			// Nullspiel: sichere Entscheidung durch die Analyse der Reihen
+			ec = nc;
+		}
+		else if (!search(ec))
+			ec = nc;
+		if (ec < 32)
+		{
+			// Karte durch Suche (bzw. Analyse der Reihen) bestimmt
+			std::string card = skat_type2string(ec);
+			*out << "CMD lege " <<
+				card.substr(0, card.length() - 1) << std::endl << std::flush;
+			return;
+		}
+		if (stich.size() == 0)
+		{
+			// Vorderhand: Anspiel einer Karte
+			if ((spiel % 100) == 23)
+			{
+				// Nullspiel: Lusche aus sicherer Reihe (skat_null_play)
+			}
+			else if ((opp_trumps > 0) && (trumps > opp_trumps))
+			{
+				// Heuristik: Trumpf ziehen
+				if (high_jacks(cards) && (pkr_spielt == pkr_self))
+				{
+					*out << "CMD lege GrU" << std::endl << std::flush;
+					return;
+				}
+				else if (high_jacks(cards) && (pkr_spielt != pkr_self))
+				{
+					*out << "CMD lege EiU" << std::endl << std::flush;
+					return;
+				}
+				else
+				{
+					if (std::count(cards.begin(), cards.end(), (size_t)0))
+					{
+						*out << "CMD lege EiU" << std::endl << std::flush;
+						return;
+					}
+					else if (std::count(cards.begin(), cards.end(), (size_t)1))
+					{
+						*out << "CMD lege GrU" << std::endl << std::flush;
+						return;
+					}
+					else if (std::count(cards.begin(), cards.end(), (size_t)2))
+					{
+						*out << "CMD lege RoU" << std::endl << std::flush;
+						return;
+					}
+					else if (std::count(cards.begin(), cards.end(), (size_t)3))
+					{
+						*out << "CMD lege ScU" << std::endl << std::flush;
+						return;
+					}
+					else
+					{
+						// TODO: falls alle Buben raus, Trumpf Ass usw. spielen
+						// TODO: sonst Trumpf Lusche anspielen
+					}
+				}					
+			}
+			// TODO: Lange Farbe spielen, beginnend bei Ass usw.
+
+			// fallback: per Zufall spielen
+			size_t idx = rnd() % cards.size();
+			std::string card = skat_type2string(cards[idx]);
+			*out << "CMD lege " << 
+				card.substr(0, card.length() - 1) << std::endl << std::flush;
+		}
+		else if ((stich.size() == 1) || (stich.size() == 2))
+		{
+			std::vector<size_t> allowed_cards;
+			skat_legal(stich[0], spiel, cards, allowed_cards);
+			assert((allowed_cards.size() > 0));
+
+			if (stich.size() == 1)
+			{
+				// Mittelhand
+				if ((spiel % 100) == 23)
+				{
+					// wenn möglich in der Farbe knapp drunter bleiben
+					size_t c;
+					if (below(stich[0], allowed_cards, c))
+					{
+*dbg << "------ below c = " << c << std::endl;
+						std::string card = skat_type2string(c);
+						*out << "CMD lege " <<
+							card.substr(0, card.length() - 1) <<
+							std::endl << std::flush;
+						return;
+					}
+					// TODO: sonst wenig höher oder (blanke Farben) abwerfen
+				}
+				else if (trump(spiel, stich[0]))
+				{
+*dbg << "????? trump played" << std::endl;
+					if (nick_stich[0] == nicks[pkr_spielt])
+					{
+						// Trumpf angespielt vom spielenden Gegner
+						// höherer Trumpf vorhanden? dann knapp Übernehmen
+						size_t c;
+						if (beyond(stich[0], allowed_cards, c))
+						{
+*dbg << "++++++ beyond c = " << c << std::endl;
+							std::string card = skat_type2string(c);
+							*out << "CMD lege " <<
+								card.substr(0, card.length() - 1) <<
+								std::endl << std::flush;
+							return;
+						}
+					}
+					else
+					{
+						if (pkr_spielt == pkr_self)
+						{
+							// Trumpf angespielt vom Gegner (ungewöhnlich)
+							// Übernehmen mit kleinem Bube, falls möglich
+							if (std::count(cards.begin(), cards.end(), (size_t)3))
+							{
+								*out << "CMD lege ScU" << std::endl << std::flush;
+								return;
+							}
+							else if (std::count(cards.begin(), cards.end(), (size_t)2))
+							{
+								*out << "CMD lege RoU" << std::endl << std::flush;
+								return;
+							}
+						}
+						else
+						{
+							// Trumpf angespielt von Mitspieler (ungewöhnlich)
+							// falls Ass oder Zehn, mit Buben flankieren
+							if (ace(stich[0]) || ten(stich[0]))
+							{
+								if (std::count(cards.begin(), cards.end(), (size_t)0))
+								{
+									*out << "CMD lege EiU" << std::endl << std::flush;
+									return;
+								}
+								else if (std::count(cards.begin(), cards.end(), (size_t)1))
+								{
+									*out << "CMD lege GrU" << std::endl << std::flush;
+									return;
+								}
+								else if (std::count(cards.begin(), cards.end(), (size_t)2))
+								{
+									*out << "CMD lege RoU" << std::endl << std::flush;
+									return;
+								}
+								else if (std::count(cards.begin(), cards.end(), (size_t)3))
+								{
+									*out << "CMD lege ScU" << std::endl << std::flush;
+									return;
+								}
+							}
+						}
+					}
+				}
+				else
+				{
+*dbg << "????? non-trump played" << std::endl;
+					if (nick_stich[0] == nicks[pkr_spielt])
+					{
+						// Farbe angespielt vom Gegner: Stechen, Übernehmen, Buttern
+						// höhere Karte vorhanden? dann knapp Übernehmen
+						size_t c;
+						if (beyond(stich[0], allowed_cards, c))
+						{
+*dbg << "++++++ beyond c = " << c << std::endl;
+							std::string card = skat_type2string(c);
+							*out << "CMD lege " <<
+								card.substr(0, card.length() - 1) <<
+								std::endl << std::flush;
+							return;
+						}
+					}
+					else
+					{
+						if (pkr_spielt == pkr_self)
+						{
+							// Farbe angespielt von Gegner: Übernehmen bzw. Stechen oder Abwerfen
+						}
+						else
+						{
+							// Farbe angespielt von Mitspieler, versuche zu Übernehmen
+						}
+					}
+				}
+			}
+			else
+			{
+				// Hinterhand
+				if ((spiel % 100) == 23)
+				{
+					// höchste Karte im Stich bestimmen
+					size_t s = stich[0];
+					if (same_suit(s, stich[1]))
+					{
+						if (((stich[1] >= 4) && (stich[1] < s)) ||
+							((stich[1] == 0) && (s >= 8)) ||
+							((stich[1] == 1) && (s >= 15)) ||
+							((stich[1] == 2) && (s >= 22)) ||
+							((stich[1] == 3) && (s >= 29)))
+						{
+							s = stich[1];
+						}
+					}
+					// wenn möglich in der Farbe knapp drunter bleiben
+					size_t c;
+					if (below(s, allowed_cards, c))
+					{
+*dbg << "------ below c = " << c << std::endl;
+						std::string card = skat_type2string(c);
+						*out << "CMD lege " <<
+							card.substr(0, card.length() - 1) <<
+							std::endl << std::flush;
+						return;
+					}
+					// TODO: strategisch Abwerfen (z.B. blanke Farben ohne 7)
+				}
+				else
+				{
+					// TODO: Stechen, Übernehmen oder Buttern
+				}
+			}
+
+*dbg << "///// fallback ac.size() = " << allowed_cards.size() << std::endl;
+			// fallback: per Zufall spielen
+			size_t idx = rnd() % allowed_cards.size();
+			std::string card = skat_type2string(allowed_cards[idx]);
+			*out << "CMD lege " << 
+				card.substr(0, card.length() - 1) << std::endl << std::flush;
+		}
+	}
+}
+
+skat_ai_player::~skat_ai_player
+	()
+{
+	delete timer;
+	delete evaluator;
+	delete ismcts;
+	delete pimc;
+}
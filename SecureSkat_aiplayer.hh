@@ -0,0 +1,120 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2002, 2003, 2004, 2005, 2007,
+               2017, 2018, 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_aiplayer_HH
+	#define INCLUDED_SecureSkat_aiplayer_HH
+
+	#include "SecureSkat_defs.hh"
+	#include "SecureSkat_rule.hh"
+	#include "SecureSkat_pool.hh"
+	#include "SecureSkat_pimc.hh"
+	#include "SecureSkat_eval.hh"
+	#include "SecureSkat_timer.hh"
+	#include "SecureSkat_ismcts.hh"
+	#include "SecureSkat_learn.hh"
+	#include "SecureSkat_book.hh"
+	#include "SecureSkat_null.hh"
+	#include "SecureSkat_player.hh"
+
+	// card play by PIMC: number of sampled worlds and maximum number of worlds
+	// for complete enumeration
+	#define SKAT_PIMC_SAMPLES	64
+	#define SKAT_PIMC_WORLDS	20000
+
+	// bidding and game selection by simulation: number of sampled deals
+	#define SKAT_EVAL_SAMPLES	48
+
+	// time management: thinking time (in ms) for a whole game and factor for
+	// the number of samples, if there is enough time left for a decision
+	#define SKAT_GAME_TIME		30000
+	#define SKAT_MORE_SAMPLES	8
+
+	// the computer player of SecureSkat_ai; the engine for the card play is
+	// "pimc", "ismcts" or "heuristik" (without search and simulation); the
+	// transposition table tt may be shared by several players (server)
+	class skat_ai_player : public skat_player
+	{
+		private:
+			std::ostream *dbg;
+			size_t pkr_self, pkr_pos, pkr_spielt;
+			size_t spiel, reiz_counter, biete, sicher;
+			size_t pkt, opp_pkt, trumps, opp_trumps;
+			bool reize_dran, lege_dran, gepasst, handspiel;
+			std::vector<std::string> nicks, names;
+			std::vector<size_t> cards, ocards, stich;
+			std::vector<std::string> nick_stich;
+			skat_cardset_t played_cards, skat_cards;
+			size_t augen_spielt;
+			// Kartenmodell: Karten, die jeder Spieler noch auf der Hand haben kann
+			skat_cardset_t possible[3];
+			skat_pimc *pimc;
+			skat_ismcts *ismcts;
+			skat_eval *evaluator;
+			const skat_model *model;
+			const skat_book *book;
+			skat_timer *timer;
+			bool hand_plan, reiz_gesendet;
+
+			void announce
+				(const size_t spiel);
+			bool beyond
+				(const size_t base, const std::vector<size_t> &cards,
+				size_t &result);
+			bool below
+				(const size_t base, const std::vector<size_t> &cards,
+				size_t &result);
+			unsigned long long deadline
+				(const size_t phase, const size_t decisions, const size_t weight);
+			void deadline_done
+				();
+			size_t choose
+				(const std::vector<size_t> &cards, const size_t min_wert,
+				const bool must, size_t &wert, size_t &sicher, bool &hand);
+			void card_known
+				(const size_t card, const size_t p);
+			void update_opp_trumps
+				();
+			size_t seat
+				(const std::string &nick);
+			bool infoset
+				(skat_infoset &is);
+			bool search
+				(size_t &result);
+
+		public:
+			// Bedenkzeit: Zeit (in ms) fuer jede Entscheidung, 0 = Zeiteinteilung
+			// durch den timer mit der Spielzeit fuer ein ganzes Spiel
+			unsigned long long bedenkzeit, spielzeit;
+
+			skat_ai_player
+				(std::ostream &o, const unsigned long long seed, skat_pool &pool,
+				const std::string &engine, const unsigned long long bz = 0,
+				const unsigned long long sz = SKAT_GAME_TIME, skat_tt *tt = NULL);
+			void debug
+				(std::ostream &o);
+			void process_command
+				(size_t &readed, char *buffer);
+			void act
+				(const bool retry);
+			~skat_ai_player
+				();
+	};
+#endif
@@ -0,0 +1,214 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_book.hh"
+
+uint32_t skat_book_key
+	(
+		const skat_cardset_t cs, const size_t pos, size_t &suit
+	)
+{
+	uint32_t key = cs & 0xF, order[4] = { 0, 1, 2, 3 }, code[4];
+	for (size_t r = 0; r < 4; r++)
+	{
+		skat_cardset_t s = (cs >> (4 + (7 * r))) & 0x7F;
+		uint32_t len = __builtin_popcount(s);
+		// ace, ten, kings and queens, the cards 9, 8 and 7 (in this order)
+		code[r] = (len << 6) | ((s & 0x01) << 5) | ((s & 0x02) << 3) |
+			(__builtin_popcount(s & 0x0C) << 2) | __builtin_popcount(s & 0x70);
+	}
+	// longest (then strongest) suit first; equal suits keep their order,
+	// thus the first one has the highest value (Eichel before Gruen, ...)
+	for (size_t i = 1; i < 4; i++)
+	{
+		for (size_t j = i; (j > 0) && (code[order[j]] > code[order[j - 1]]); j--)
+			std::swap(order[j], order[j - 1]);
+	}
+	for (size_t i = 0; i < 4; i++)
+		key |= (code[order[i]] & 0x3F) << (4 + (6 * i));
+	suit = order[0];
+	return key | ((uint32_t)(pos % 3) << 28);
+}
+
+size_t skat_book_index
+	(
+		const size_t kind, const size_t mode
+	)
+{
+	return (kind == SKAT_LEARN_GRAND) ? (2 + mode) : mode;
+}
+
+uint32_t skat_book_hash
+	(
+		const uint32_t key
+	)
+{
+	uint32_t h = key * 0x9E3779B1U;
+	return h ^ (h >> 15);
+}
+
+skat_book::skat_book
+	(const std::string &file):
+		path(file), state(0), table(NULL), data(NULL), data_size(0)
+{
+	pthread_mutex_init(&mutex, NULL);
+	memset(&header, 0, sizeof(header));
+}
+
+bool skat_book::check
+	(const unsigned char *mem, const size_t size)
+{
+	skat_book_header h;
+	if ((mem == NULL) || (size < sizeof(h)))
+		return false;
+	memcpy(&h, mem, sizeof(h));
+	if (memcmp(h.magic, SKAT_BOOK_MAGIC, sizeof(h.magic)))
+		return false;
+	if ((h.size == 0) || (h.size & (h.size - 1)) || (h.count >= h.size))
+		return false;
+	if (((size - sizeof(h)) / sizeof(skat_book_entry)) < h.size)
+		return false;
+	header = h;
+	return true;
+}
+
+// memory mapping of the file (without reading it)
+bool skat_book::map
+	()
+{
+	if (path.length() == 0)
+		return false;
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if ((fstat(fd, &st) < 0) || (st.st_size < (off_t)sizeof(skat_book_header)))
+	{
+		close(fd);
+		return false;
+	}
+	void *mem = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED)
+	{
+		perror("skat_book (mmap)");
+		return false;
+	}
+	if (!check((const unsigned char*)mem, st.st_size))
+	{
+		std::cerr << "skat_book: " << path << " is not valid" << std::endl;
+		munmap(mem, st.st_size);
+		return false;
+	}
+	madvise(mem, st.st_size, MADV_RANDOM);
+	data = (const unsigned char*)mem, data_size = st.st_size;
+	table = (const skat_book_entry*)(data + sizeof(skat_book_header));
+	return true;
+}
+
+bool skat_book::ready
+	()
+{
+	if (__atomic_load_n(&state, __ATOMIC_ACQUIRE) == 0)
+	{
+		pthread_mutex_lock(&mutex);
+		if (state == 0)
+			__atomic_store_n(&state, (map()) ? 1 : -1, __ATOMIC_RELEASE);
+		pthread_mutex_unlock(&mutex);
+	}
+	return (state == 1);
+}
+
+// the entry of the key or NULL (open addressing with linear probing)
+const skat_book_entry *skat_book::lookup
+	(const uint32_t key) const
+{
+	if ((__atomic_load_n(&state, __ATOMIC_ACQUIRE) != 1) || (key == 0))
+		return NULL;
+	uint32_t mask = header.size - 1;
+	for (uint32_t i = skat_book_hash(key) & mask; ; i = (i + 1) & mask)
+	{
+		if (table[i].key == key)
+			return &table[i];
+		if (table[i].key == 0)
+			return NULL;
+	}
+}
+
+size_t skat_book::evaluate
+	(const skat_cardset_t cards, const size_t pos,
+	const size_t min_wert, const skat_model &model,
+	std::vector<skat_bid> &result) const
+{
+	result.clear();
+	if (skat_cardset_size(cards) != 10)
+		return 0;
+	size_t suit = 0;
+	const skat_book_entry *e = lookup(skat_book_key(cards, pos, suit));
+	if (e == NULL)
+		return 0;
+	model.evaluate(cards, pos, min_wert, result);
+	for (size_t i = 0; i < result.size(); i++)
+	{
+		skat_bid &b = result[i];
+		size_t kind = skat_learn_kind(b.spiel), gwert = skat_spiel2gwert(b.spiel);
+		if ((kind == SKAT_LEARN_NULL) ||
+			((kind == SKAT_LEARN_SUIT) && (gwert != (12 - suit))))
+				continue;
+		size_t mode = (b.hand) ? SKAT_LEARN_HAND : SKAT_LEARN_SKAT;
+		// solved deals as in the simulation of skat_eval
+		b.win = skat_eval_combine(e->win[skat_book_index(kind, mode)] / 255.0,
+			model.win(b.spiel, mode, cards, pos));
+		b.samples = e->n;
+		long wert = b.wert;
+		double q = b.win;
+		if (wert < (long)min_wert)
+		{
+			// overbid: lost with the next multiple of the Grundwert
+			wert = ((min_wert + gwert - 1) / gwert) * gwert;
+			q = 0.0;
+		}
+		b.score = skat_eval_score(q, wert);
+	}
+	return result.size();
+}
+
+skat_book::~skat_book
+	()
+{
+	if (data != NULL)
+		munmap((void*)data, data_size);
+	pthread_mutex_destroy(&mutex);
+}
+
+static std::string skat_book_file
+	()
+{
+	const char *env = getenv("SECURESKAT_BOOK");
+	return (env != NULL) ? env : SKAT_BOOK;
+}
+
+static skat_book skat_book_instance(skat_book_file());
+
+skat_book &skat_book_default
+	()
+{
+	return skat_book_instance;
+}
@@ -0,0 +1,124 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_book_HH
+	#define INCLUDED_SecureSkat_book_HH
+
+	#include "SecureSkat_defs.hh"
+	#include "SecureSkat_rule.hh"
+	#include "SecureSkat_eval.hh"
+	#include "SecureSkat_learn.hh"
+
+	// winning probabilities of an entry: kind (SKAT_LEARN_SUIT or
+	// SKAT_LEARN_GRAND) and mode (SKAT_LEARN_SKAT or SKAT_LEARN_HAND)
+	#define SKAT_BOOK_WINS		4
+
+	#define SKAT_BOOK_MAGIC		"SSKATBK1"
+
+	#ifndef SKAT_BOOK
+		#define SKAT_BOOK		"SecureSkat.book"
+	#endif
+
+	// file header, followed by a hash table of size entries (a power of two)
+	struct skat_book_header
+	{
+		char magic[8];
+		uint32_t size;
+		uint32_t count;
+		uint32_t deals;
+		uint32_t reserved;
+	};
+
+	// an entry of the hash table (key 0 is empty, no hand has this key) with
+	// the number of solved hands and the probabilities in units of 1/255
+	struct skat_book_entry
+	{
+		uint32_t key;
+		uint16_t n;
+		uint8_t win[SKAT_BOOK_WINS];
+		uint8_t reserved[2];
+	};
+
+	// Canonical key of 10 cards at position pos (0 = Vorhand): the jacks as
+	// they are and for each suit 6 bits (ace, ten, number of kings and queens,
+	// number of the cards 9, 8 and 7). The suits are sorted (longest first),
+	// thus permutations of the suits give the same key. suit is set to the
+	// suit (0 = Eichel, ..., 3 = Schellen) that is played as trump by the
+	// suit game of the entry, the one with the highest value of equal suits.
+	uint32_t skat_book_key
+		(
+			const skat_cardset_t cs, const size_t pos, size_t &suit
+		);
+
+	size_t skat_book_index
+		(
+			const size_t kind, const size_t mode
+		);
+
+	// first slot of the key in the hash table (modulo its size)
+	uint32_t skat_book_hash
+		(
+			const uint32_t key
+		);
+
+	// Opening book: winning probabilities of the suit game (in the suit given
+	// by skat_book_key) and of Grand, as hand game and with the skat, for
+	// the common hands. They are estimated by SecureSkat_bookgen from solved
+	// deals (as the training of skat_model) and bidding on 10 cards needs a
+	// single lookup instead of the simulation by skat_eval. The file is
+	// mapped into memory when it is used first.
+	class skat_book
+	{
+		private:
+			std::string path;
+			int state;						// 0 unknown, 1 ready, -1 missing
+			pthread_mutex_t mutex;
+			const skat_book_entry *table;
+			const unsigned char *data;
+			size_t data_size;
+			skat_book_header header;
+
+			bool check
+				(const unsigned char *mem, const size_t size);
+			bool map
+				();
+
+		public:
+			skat_book
+				(const std::string &file);
+			bool ready
+				();
+			const skat_book_entry *lookup
+				(const uint32_t key) const;
+			// the candidate games as skat_model::evaluate, where the book
+			// replaces the model for the suit game and for Grand; returns 0,
+			// if the hand is not contained (i.e. it must be simulated)
+			size_t evaluate
+				(const skat_cardset_t cards, const size_t pos,
+				const size_t min_wert, const skat_model &model,
+				std::vector<skat_bid> &result) const;
+			~skat_book
+				();
+	};
+
+	// the default book (environment SECURESKAT_BOOK or installed)
+	skat_book &skat_book_default
+		();
+#endif
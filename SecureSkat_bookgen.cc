@@ -0,0 +1,239 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+// Generator of the opening book: in random deals each of the three hands is
+// played by the double-dummy solver as declarer of the suit game given by
+// skat_book_key and of Grand, each as hand game and with the skat (put away
+// by skat_eval_druecken as the training of skat_model does). The results of
+// the hands with the same key are counted; the winning probability is
+// shrunk towards the mean prediction of skat_model, thus rare keys are not
+// estimated by a few deals alone. Keys with less than min hands are left
+// out, such hands are simulated by SecureSkat_ai.
+// usage: SecureSkat_bookgen [file] [deals] [seed] [min]
+
+#include "SecureSkat_defs.hh"
+#include "SecureSkat_rule.hh"
+#include "SecureSkat_search.hh"
+#include "SecureSkat_pool.hh"
+#include "SecureSkat_player.hh"
+#include "SecureSkat_learn.hh"
+#include "SecureSkat_book.hh"
+
+#define SKAT_BOOKGEN_CHUNK	16
+
+// weight of the model's prediction (in hands) for the shrinkage
+#define SKAT_BOOKGEN_PRIOR	4.0
+
+struct bookgen_sample
+{
+	uint32_t key;
+	bool won[SKAT_BOOK_WINS];
+	float p[SKAT_BOOK_WINS];
+};
+
+struct bookgen_count
+{
+	size_t n;
+	double won[SKAT_BOOK_WINS], p[SKAT_BOOK_WINS];
+};
+
+struct bookgen_job
+{
+	unsigned long long seed, first, count;
+	std::vector<bookgen_sample> *samples;
+	std::vector<skat_solver*> *solver;
+	const skat_model *model;
+};
+
+void bookgen_solve
+	(void *arg, const size_t worker)
+{
+	bookgen_job *j = (bookgen_job*)arg;
+	skat_solver *s = (*j->solver)[worker];
+	for (unsigned long long d = j->first; d < (j->first + j->count); d++)
+	{
+		// deal: seat i is at position i (0 = Vorhand leads the first trick)
+		unsigned long long state = j->seed + d;
+		size_t cv[32];
+		for (size_t c = 0; c < 32; c++)
+			cv[c] = c;
+		for (size_t k = 32; k > 1; k--)
+			std::swap(cv[k - 1], cv[skat_splitmix(state) % k]);
+		skat_cardset_t h[4] = { 0, 0, 0, 0 };
+		for (size_t k = 0; k < 32; k++)
+			h[(k < 30) ? (k / 10) : 3] |= skat_card2set(cv[k]);
+		for (size_t i = 0; i < 3; i++)
+		{
+			bookgen_sample &bs = (*j->samples)[(d * 3) + i];
+			size_t suit = 0;
+			bs.key = skat_book_key(h[i], i, suit);
+			size_t spiele[2] = { 12 - suit, 24 };
+			for (size_t g = 0; g < 2; g++)
+			{
+				size_t spiel = spiele[g];
+				size_t kind = (g == 0) ? SKAT_LEARN_SUIT : SKAT_LEARN_GRAND;
+				size_t hi = skat_book_index(kind, SKAT_LEARN_HAND);
+				size_t si = skat_book_index(kind, SKAT_LEARN_SKAT);
+				skat_position p;
+				// hand game: the skat counts for the declarer
+				skat_position_init(p, spiel, i, 0);
+				p.hand[0] = h[0], p.hand[1] = h[1], p.hand[2] = h[2];
+				p.augen = skat_augen(h[3]);
+				bs.won[hi] = s->wins(p);
+				// the skat is taken and two cards are put away
+				skat_cardset_t all = h[i] | h[3], dr = skat_eval_druecken(spiel, all);
+				skat_position_init(p, spiel, i, 0);
+				p.hand[0] = h[0], p.hand[1] = h[1], p.hand[2] = h[2];
+				p.hand[i] = all & ~dr;
+				p.augen = skat_augen(dr);
+				bs.won[si] = s->wins(p);
+				bs.p[hi] = bs.p[si] = 0.0f;
+				if (j->model != NULL)
+				{
+					bs.p[hi] = j->model->win(spiel, SKAT_LEARN_HAND, h[i], i);
+					bs.p[si] = j->model->win(spiel, SKAT_LEARN_SKAT, h[i], i);
+				}
+			}
+		}
+	}
+}
+
+int main (int argc, char **argv)
+{
+	std::string file = "SecureSkat.book";
+	unsigned long long deals = 100000, seed = 0;
+	size_t min = 4;
+	if (argc > 1)
+		file = argv[1];
+	if (argc > 2)
+		deals = strtoull(argv[2], NULL, 10);
+	if (argc > 3)
+		seed = strtoull(argv[3], NULL, 10);
+	if (argc > 4)
+		min = strtoul(argv[4], NULL, 10);
+	if (deals < 1)
+		deals = 1;
+	if (min < 1)
+		min = 1;
+	const skat_model *model = NULL;
+	if (skat_model_default().ready)
+		model = &skat_model_default();
+	else
+		std::cerr << "SecureSkat_bookgen: no model, no shrinkage" << std::endl;
+
+	// solve the deals in parallel
+	unsigned long long start = skat_msec();
+	std::vector<bookgen_sample> samples(deals * 3);
+	skat_pool pool;
+	std::vector<skat_solver*> solver;
+	for (size_t i = 0; i < pool.size(); i++)
+		solver.push_back(new skat_solver());
+	std::vector<bookgen_job> jobs;
+	for (unsigned long long d = 0; d < deals; d += SKAT_BOOKGEN_CHUNK)
+	{
+		bookgen_job j;
+		j.seed = seed, j.first = d;
+		j.count = std::min((unsigned long long)SKAT_BOOKGEN_CHUNK, deals - d);
+		j.samples = &samples, j.solver = &solver, j.model = model;
+		jobs.push_back(j);
+	}
+	for (size_t i = 0; i < jobs.size(); i++)
+		pool.submit(bookgen_solve, &jobs[i]);
+	pool.wait();
+	for (size_t i = 0; i < solver.size(); i++)
+		delete solver[i];
+	std::cerr << "SecureSkat_bookgen: " << deals << " deals solved in " <<
+		(skat_msec() - start) << " ms" << std::endl;
+
+	// count the hands of each key
+	std::map<uint32_t, bookgen_count> counts;
+	for (size_t k = 0; k < samples.size(); k++)
+	{
+		bookgen_count &c = counts[samples[k].key];
+		c.n++;
+		for (size_t w = 0; w < SKAT_BOOK_WINS; w++)
+		{
+			c.won[w] += (samples[k].won[w]) ? 1.0 : 0.0;
+			c.p[w] += samples[k].p[w];
+		}
+	}
+	size_t count = 0, covered = 0;
+	for (std::map<uint32_t, bookgen_count>::const_iterator it = counts.begin();
+		it != counts.end(); ++it)
+	{
+		if (it->second.n >= min)
+			count++, covered += it->second.n;
+	}
+	uint32_t size = 1024;
+	while (size < (2 * count))
+		size *= 2;
+
+	// hash table with linear probing (at most half full)
+	skat_book_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SKAT_BOOK_MAGIC, sizeof(header.magic));
+	header.size = size, header.count = count, header.deals = deals;
+	std::vector<skat_book_entry> table(size);
+	memset(&table[0], 0, size * sizeof(skat_book_entry));
+	for (std::map<uint32_t, bookgen_count>::const_iterator it = counts.begin();
+		it != counts.end(); ++it)
+	{
+		const bookgen_count &c = it->second;
+		if (c.n < min)
+			continue;
+		uint32_t i = skat_book_hash(it->first) & (size - 1);
+		while (table[i].key != 0)
+			i = (i + 1) & (size - 1);
+		table[i].key = it->first;
+		table[i].n = std::min(c.n, (size_t)65535);
+		for (size_t w = 0; w < SKAT_BOOK_WINS; w++)
+		{
+			double m = (model != NULL) ? SKAT_BOOKGEN_PRIOR : 0.0;
+			double q = (c.won[w] + (m * (c.p[w] / c.n))) / (c.n + m);
+			table[i].win[w] = (uint8_t)((255.0 * q) + 0.5);
+		}
+	}
+	std::cerr << "SecureSkat_bookgen: " << counts.size() << " keys, " <<
+		count << " with at least " << min << " hands (" <<
+		((100.0 * covered) / samples.size()) << "% of the hands)" << std::endl;
+
+	// write a temporary file and rename it, thus the book is never partial
+	std::string tmp = file + ".tmp";
+	FILE *f = fopen(tmp.c_str(), "wb");
+	if (f == NULL)
+	{
+		perror("SecureSkat_bookgen (fopen)");
+		return EXIT_FAILURE;
+	}
+	if ((fwrite(&header, sizeof(header), 1, f) != 1) ||
+		(fwrite(&table[0], sizeof(skat_book_entry), size, f) != size) ||
+		fclose(f))
+	{
+		perror("SecureSkat_bookgen (fwrite)");
+		unlink(tmp.c_str());
+		return EXIT_FAILURE;
+	}
+	if (rename(tmp.c_str(), file.c_str()) < 0)
+	{
+		perror("SecureSkat_bookgen (rename)");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
@@ -26,6 +26,7 @@
     #include <cassert>
     #include <cctype>
     #include <cerrno>
+    #include <cmath>
     #include <csignal>
     #include <cstdio>
     #include <cstdlib>
@@ -36,15 +37,21 @@
     #include <fcntl.h>
     #include <netdb.h>
     #include <netinet/in.h>
+    #include <pthread.h>
+    #include <stdint.h>
 
+    #include <sys/mman.h>
     #include <sys/socket.h>
     #include <sys/stat.h>
+    #include <sys/time.h>
+    #include <sys/un.h>
     #include <sys/wait.h>
     #include <termios.h>
     #include <unistd.h>
     
     // STL classes
     #include <algorithm>
+    #include <deque>
     #include <fstream>
     #include <iostream>
     #include <list>
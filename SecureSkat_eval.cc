@@ -0,0 +1,459 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_eval.hh"
+#include "SecureSkat_learn.hh"
+
+static const size_t skat_eval_spiele[] = { 9, 10, 11, 12, 24, 23 };
+
+// expected score of the declarer by the extended Seeger-Fabian system
+// relative to the defenders: the game value and 50 points for a won game,
+// twice the game value and 50 points less for a lost game, in which each
+// defender gets 40 points
+double skat_eval_score
+	(
+		const double win, const double wert
+	)
+{
+	return (win * (wert + 50)) - ((1.0 - win) * ((2 * wert) + 50 + 40));
+}
+
+static double skat_eval_logit
+	(
+		const double win
+	)
+{
+	double p = std::min(std::max(win, 0.005), 0.995);
+	return log(p / (1.0 - p));
+}
+
+// logit(q) = a + b * logit(win) with the estimated probability win
+double skat_eval_calibrate
+	(
+		const double win, const double a, const double b
+	)
+{
+	return 1.0 / (1.0 + exp(-(a + (b * skat_eval_logit(win)))));
+}
+
+// simulated probability win and prediction prior of the learned model
+// (negative, if there is no model) as one calibrated probability
+double skat_eval_combine
+	(
+		const double win, const double prior
+	)
+{
+	if (prior < 0.0)
+	{
+		return skat_eval_calibrate(win, SKAT_EVAL_CALIBRATE_A0,
+			SKAT_EVAL_CALIBRATE_B0);
+	}
+	return 1.0 / (1.0 + exp(-(SKAT_EVAL_CALIBRATE_A +
+		(SKAT_EVAL_CALIBRATE_B * skat_eval_logit(win)) +
+		(SKAT_EVAL_CALIBRATE_C * skat_eval_logit(prior)))));
+}
+
+// game value (as in SecureSkat_game.cc) for a won game without Schneider
+size_t skat_eval_wert
+	(
+		const size_t spiel, const bool hand, const skat_cardset_t cs
+	)
+{
+	if ((spiel % 1000) == 323) // Null Ouvert
+		return (hand) ? 59 : 46;
+	if ((spiel % 100) == 23)
+		return (hand) ? 35 : 23;
+	return (skat_spitzen(spiel % 100, cs) + ((hand) ? 2 : 1)) *
+		skat_spiel2gwert(spiel % 100);
+}
+
+// quick choice of the two cards to put away (druecken) from 12 cards
+skat_cardset_t skat_eval_druecken
+	(
+		const size_t spiel, const skat_cardset_t cs
+	)
+{
+	skat_cardset_t tm = skat_trumpmask(spiel), d = 0;
+	bool null = ((spiel % 100) == 23);
+	for (size_t k = 0; k < 2; k++)
+	{
+		size_t card = 99;
+		int best = -1000;
+		for (size_t c = 0; c < 32; c++)
+		{
+			skat_cardset_t cm = skat_card2set(c);
+			if (!(cs & cm) || (d & cm))
+				continue;
+			skat_cardset_t sm = skat_suitmask(spiel, c);
+			int len = skat_cardset_size(cs & ~d & sm), sc = 0;
+			size_t rank = skat_cardrank(spiel, c);
+			if (null)
+			{
+				// high cards of short suits are the dangerous ones
+				sc = 10 * (7 - (int)rank) - 3 * len;
+			}
+			else if (cm & tm)
+			{
+				// only the lowest trumps, if nothing else is left
+				sc = -200 + 10 * (int)rank;
+			}
+			else
+			{
+				// keep the aces, save points and make suits void
+				if (skat_pktwert[c] == 11)
+					sc = -50;
+				else
+					sc = (int)skat_pktwert[c] + 4 * (4 - len);
+				// a ten without the ace of its suit is at risk
+				if ((skat_pktwert[c] == 10) &&
+					!(cs & ~d & sm & skat_card2set(c - 1)))
+						sc += 10;
+			}
+			if (sc > best)
+				best = sc, card = c;
+		}
+		d |= skat_card2set(card);
+	}
+	return d;
+}
+
+// a discard d (two of the 12 cards cs) is dominated, if an equivalent card
+// (same row and only own cards in between) with more points, or for Null
+// with smaller index, could be put away instead
+bool skat_eval_dominated
+	(
+		const size_t spiel, const skat_cardset_t cs, const skat_cardset_t d
+	)
+{
+	bool null = ((spiel % 100) == 23);
+	for (size_t c = 0; c < 32; c++)
+	{
+		if (!(d & skat_card2set(c)))
+			continue;
+		size_t row = skat_cardrow(spiel, c), rank = skat_cardrank(spiel, c);
+		// walk through the row in both directions while only own cards
+		for (int dir = -1; dir <= 1; dir += 2)
+		{
+			for (size_t k = rank + dir; k < 18; k += dir)
+			{
+				size_t e = 99;
+				for (size_t x = 0; x < 32; x++)
+				{
+					if ((skat_cardrow(spiel, x) == row) &&
+						(skat_cardrank(spiel, x) == k))
+					{
+						e = x;
+						break;
+					}
+				}
+				if ((e == 99) || !(cs & skat_card2set(e)))
+					break;
+				if (d & skat_card2set(e))
+					continue;
+				// the equivalent card e is kept, but should go instead of c
+				if (null && (e < c))
+					return true;
+				if (!null && ((skat_pktwert[e] > skat_pktwert[c]) ||
+					((skat_pktwert[e] == skat_pktwert[c]) && (e < c))))
+						return true;
+			}
+		}
+	}
+	return false;
+}
+
+skat_eval::skat_eval
+	(skat_pool &p, skat_tt *shared):
+		pool(p), tt(shared), tt_own(false), samples(48), chunk(4),
+		min_samples(8), max_samples(0), model(NULL)
+{
+	// all solvers share one transposition table (own or given by the caller)
+	if (tt == NULL)
+		tt = new skat_tt(20), tt_own = true;
+	for (size_t i = 0; i < pool.size(); i++)
+	{
+		solver.push_back(new skat_solver(*tt));
+		state.push_back((((unsigned long long)tmcg_mpz_wrandom_ui()) << 32) ^
+			tmcg_mpz_wrandom_ui() ^ (i + 1));
+	}
+}
+
+// hopeless candidates are dropped after the first samples
+bool skat_eval::active
+	(const size_t c)
+{
+	size_t n = __sync_fetch_and_add(&done[c], 0);
+	return ((n < min_samples) ||
+		((5 * __sync_fetch_and_add(&wins[c], 0)) >= n));
+}
+
+void skat_eval::simulate
+	(void *arg, const size_t worker)
+{
+	job *j = (job*)arg;
+	skat_eval *ev = j->eval;
+	skat_solver *s = ev->solver[worker];
+	std::vector<size_t> uc;
+	skat_cardset2vector(~j->cards, uc);
+	bool taken = (skat_cardset_size(j->cards) == 12);
+	size_t lead = (3 - j->pos) % 3;
+	// sample the worlds: seat 0 is the declarer, seat 1 and 2 follow
+	std::vector<skat_cardset_t> w1, w2, ws;
+	for (size_t i = 0; i < j->count; i++)
+	{
+		skat_cardset_t h[3] = { 0, 0, 0 };
+		for (size_t k = uc.size(); k > 1; k--)
+			std::swap(uc[k - 1], uc[skat_random(ev->state[worker]) % k]);
+		for (size_t k = 0; k < uc.size(); k++)
+			h[(k < 10) ? 0 : ((k < 20) ? 1 : 2)] |= skat_card2set(uc[k]);
+		w1.push_back(h[0]), w2.push_back(h[1]), ws.push_back(h[2]);
+	}
+	s->limit(j->deadline);
+	// candidates in the outer loop, since the solver is bound to a game
+	for (size_t c = 0; c < ev->candidates.size(); c++)
+	{
+		const skat_bid &b = ev->candidates[c];
+		size_t gwert = skat_spiel2gwert(b.spiel);
+		for (size_t i = 0; i < w1.size(); i++)
+		{
+			if (!ev->active(c))
+				break;
+			if (j->deadline && (skat_msec() > j->deadline))
+				return;
+			skat_position p;
+			skat_cardset_t all = j->cards | ws[i];
+			skat_position_init(p, b.spiel, 0, lead);
+			if (b.hand)
+			{
+				p.hand[0] = j->cards;
+				p.augen = skat_augen(ws[i]);
+			}
+			else
+			{
+				skat_cardset_t d = skat_eval_druecken(b.spiel, all);
+				p.hand[0] = all & ~d;
+				p.augen = skat_augen(d);
+			}
+			p.hand[1] = w1[i], p.hand[2] = w2[i];
+			bool win = s->wins(p);
+			if (s->aborted)
+				return;
+			// the value depends on the Spitzen with the skat
+			long wert = skat_eval_wert(b.spiel, b.hand, (taken) ?
+				j->cards : all);
+			if (wert < (long)j->min_wert)
+			{
+				// overbid: lost with the next multiple of the Grundwert
+				win = false;
+				wert = ((j->min_wert + gwert - 1) / gwert) * gwert;
+			}
+			__sync_fetch_and_add(&ev->werte[c], wert);
+			__sync_fetch_and_add(&ev->wins[c], (win) ? 1 : 0);
+			__sync_fetch_and_add(&ev->done[c], 1);
+		}
+	}
+}
+
+// evaluates the candidate games of a declarer with the given 10 cards (or
+// 12 cards, if the skat was already taken) at position pos (0 = Vorhand);
+// the bid has to reach min_wert; returns the number of candidates
+size_t skat_eval::evaluate
+	(const skat_cardset_t cards, const size_t pos,
+	const size_t min_wert, const unsigned long long deadline,
+	std::vector<skat_bid> &result)
+{
+	size_t n = skat_cardset_size(cards);
+	candidates.clear();
+	for (size_t i = 0; i < 6; i++)
+	{
+		size_t spiel = skat_eval_spiele[i];
+		size_t trumps = skat_cardset_size(cards & skat_trumpmask(spiel));
+		size_t aces = skat_cardset_size(cards &
+			(skat_card2set(4) | skat_card2set(11) | skat_card2set(18) |
+			skat_card2set(25)));
+		// obviously hopeless games are not simulated at all
+		if ((spiel < 23) && (trumps < ((n / 2) - 1)))
+			continue;
+		if ((spiel == 24) && ((trumps == 0) || ((trumps + aces) < 3)))
+			continue;
+		for (size_t h = 0; h < ((n == 12) ? 1 : 2); h++)
+		{
+			skat_bid b;
+			size_t mode = (n == 12) ? SKAT_LEARN_TAKEN :
+				((h == 1) ? SKAT_LEARN_HAND : SKAT_LEARN_SKAT);
+			// ... as well as the games that the learned model considers lost
+			double prior = (model != NULL) ?
+				model->win(spiel, mode, cards, pos) : -1.0;
+			if ((model != NULL) && (prior < SKAT_LEARN_HOPELESS))
+				continue;
+			// the prediction of the model until the simulation is done
+			b.spiel = spiel, b.hand = (h == 1);
+			b.win = prior, b.score = 0.0, b.samples = 0;
+			b.wert = skat_eval_wert(spiel, b.hand, cards);
+			candidates.push_back(b);
+		}
+	}
+	wins.assign(candidates.size(), 0);
+	done.assign(candidates.size(), 0);
+	werte.assign(candidates.size(), 0);
+	// sampling in rounds as long as the next round fits before the deadline
+	for (size_t n = 0; n < std::max(samples, max_samples); n += samples)
+	{
+		unsigned long long round_start = skat_msec();
+		std::vector<job> jobs;
+		for (size_t first = 0; first < samples; first += chunk)
+		{
+			job j;
+			j.eval = this, j.cards = cards, j.pos = pos;
+			j.min_wert = min_wert, j.deadline = deadline;
+			j.count = std::min(chunk, samples - first);
+			jobs.push_back(j);
+		}
+		for (size_t i = 0; i < jobs.size(); i++)
+			pool.submit(simulate, &jobs[i]);
+		pool.wait();
+		unsigned long long now = skat_msec();
+		if (!deadline || ((now + (now - round_start)) > deadline))
+			break;
+	}
+	result.clear();
+	for (size_t c = 0; c < candidates.size(); c++)
+	{
+		skat_bid b = candidates[c];
+		b.samples = done[c];
+		if (b.samples > 0)
+		{
+			b.win = skat_eval_combine((double)wins[c] / b.samples,
+				candidates[c].win);
+			b.score = skat_eval_score(b.win, (double)werte[c] / b.samples);
+		}
+		else
+			b.score = -1000.0;
+		result.push_back(b);
+	}
+	return result.size();
+}
+
+void skat_eval::discard
+	(void *arg, const size_t worker)
+{
+	discard_job *j = (discard_job*)arg;
+	skat_eval *ev = j->eval;
+	skat_solver *s = ev->solver[worker];
+	s->limit(j->deadline);
+	for (size_t i = j->first; i < j->last; i++)
+	{
+		skat_position p;
+		skat_cardset_t d = ev->discards[j->discard];
+		skat_position_init(p, j->spiel, 0, j->lead);
+		p.hand[0] = ~(ev->dw1[i] | ev->dw2[i] | d);
+		p.hand[1] = ev->dw1[i], p.hand[2] = ev->dw2[i];
+		p.augen = skat_augen(d);
+		bool win = s->wins(p);
+		if (s->aborted)
+			break;
+		__sync_fetch_and_add(&ev->dwins[j->discard], (win) ? 1 : 0);
+		__sync_fetch_and_add(&ev->ddone[j->discard], 1);
+	}
+}
+
+// chooses the two cards to put away from the 12 cards of the declarer; all
+// 66 discards without the dominated ones are solved on the same random
+// deals, and after each round only the better half of them remains, while
+// the number of deals is doubled (successive halving until the deadline)
+skat_cardset_t skat_eval::druecken
+	(const skat_cardset_t cards, const size_t spiel,
+	const size_t pos, const unsigned long long deadline)
+{
+	std::vector<size_t> cv, uc, alive;
+	skat_cardset2vector(cards, cv);
+	discards.clear();
+	for (size_t a = 0; a < cv.size(); a++)
+	{
+		for (size_t b = a + 1; b < cv.size(); b++)
+		{
+			skat_cardset_t d = skat_card2set(cv[a]) | skat_card2set(cv[b]);
+			if (!skat_eval_dominated(spiel, cards, d))
+				alive.push_back(discards.size()), discards.push_back(d);
+		}
+	}
+	if ((cv.size() != 12) || (discards.size() == 0))
+		return skat_eval_druecken(spiel, cards);
+	skat_cardset2vector(~cards, uc);
+	dw1.clear(), dw2.clear();
+	for (size_t i = 0; i < samples; i++)
+	{
+		skat_cardset_t h[2] = { 0, 0 };
+		for (size_t k = uc.size(); k > 1; k--)
+			std::swap(uc[k - 1], uc[skat_random(state[0]) % k]);
+		for (size_t k = 0; k < uc.size(); k++)
+			h[(k < 10) ? 0 : 1] |= skat_card2set(uc[k]);
+		dw1.push_back(h[0]), dw2.push_back(h[1]);
+	}
+	dwins.assign(discards.size(), 0);
+	ddone.assign(discards.size(), 0);
+	size_t first = 0, step = 2;
+	bool null = ((spiel % 100) == 23);
+	while ((alive.size() > 1) && (first < samples))
+	{
+		if (deadline && (skat_msec() > deadline))
+			break;
+		size_t last = std::min(samples, first + step);
+		std::vector<discard_job> jobs;
+		for (size_t i = 0; i < alive.size(); i++)
+		{
+			discard_job j;
+			j.eval = this, j.spiel = spiel, j.lead = (3 - pos) % 3;
+			j.discard = alive[i], j.first = first, j.last = last;
+			j.deadline = deadline;
+			jobs.push_back(j);
+		}
+		for (size_t i = 0; i < jobs.size(); i++)
+			pool.submit(discard, &jobs[i]);
+		pool.wait();
+		// rank by winning rate, then by the points put away
+		std::vector< std::pair<double, size_t> > rank;
+		for (size_t i = 0; i < alive.size(); i++)
+		{
+			size_t k = alive[i];
+			double r = (ddone[k] > 0) ? ((double)dwins[k] / ddone[k]) : -1.0;
+			if (!null)
+				r += skat_augen(discards[k]) / 1000.0;
+			rank.push_back(std::pair<double, size_t>(-r, k));
+		}
+		std::sort(rank.begin(), rank.end());
+		alive.clear();
+		for (size_t i = 0; i < std::max((size_t)1, (rank.size() + 1) / 2); i++)
+			alive.push_back(rank[i].second);
+		first = last, step *= 2;
+	}
+	if ((discards.size() > 1) && (ddone[alive[0]] == 0))
+		return skat_eval_druecken(spiel, cards);
+	return discards[alive[0]];
+}
+
+skat_eval::~skat_eval
+	()
+{
+	for (size_t i = 0; i < solver.size(); i++)
+		delete solver[i];
+	if (tt_own)
+		delete tt;
+}
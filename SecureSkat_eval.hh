@@ -0,0 +1,139 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_eval_HH
+	#define INCLUDED_SecureSkat_eval_HH
+
+	#include "SecureSkat_defs.hh"
+	#include "SecureSkat_rule.hh"
+	#include "SecureSkat_search.hh"
+	#include "SecureSkat_pool.hh"
+	#include "SecureSkat_pimc.hh"
+
+	// estimation for a candidate game of the declarer
+	struct skat_bid
+	{
+		size_t spiel;		// game (9, 10, 11, 12, 23, 24)
+		bool hand;			// played without taking the skat
+		double win;			// estimated probability of winning
+		double score;		// expected score (skat_eval_score)
+		size_t wert;		// game value (Spielwert) with the own cards
+		size_t samples;		// number of evaluated worlds
+	};
+
+	// calibration of the winning probabilities of the simulation (solved
+	// random deals favour the declarer), fitted to self-play outcomes:
+	// logit(q) = A + B * logit(win) + C * logit(prior) with the prediction
+	// prior of the learned model, only A0 and B0 without a model
+	#define SKAT_EVAL_CALIBRATE_A	0.19
+	#define SKAT_EVAL_CALIBRATE_B	0.13
+	#define SKAT_EVAL_CALIBRATE_C	0.63
+	#define SKAT_EVAL_CALIBRATE_A0	-0.25
+	#define SKAT_EVAL_CALIBRATE_B0	0.33
+
+	double skat_eval_score
+		(
+			const double win, const double wert
+		);
+
+	double skat_eval_calibrate
+		(
+			const double win, const double a, const double b
+		);
+
+	double skat_eval_combine
+		(
+			const double win, const double prior
+		);
+
+	size_t skat_eval_wert
+		(
+			const size_t spiel, const bool hand, const skat_cardset_t cs
+		);
+
+	skat_cardset_t skat_eval_druecken
+		(
+			const size_t spiel, const skat_cardset_t cs
+		);
+
+	bool skat_eval_dominated
+		(
+			const size_t spiel, const skat_cardset_t cs,
+			const skat_cardset_t d
+		);
+
+	class skat_model;
+
+	// evaluation of all candidate games by Monte Carlo simulation, i.e., the
+	// remaining cards are distributed at random and each deal is solved
+	class skat_eval
+	{
+		private:
+			skat_pool &pool;
+			skat_tt *tt;
+			bool tt_own;
+			std::vector<skat_solver*> solver;
+			std::vector<unsigned long long> state;
+			std::vector<skat_bid> candidates;
+			std::vector<size_t> wins, done;
+			std::vector<long> werte;
+			std::vector<skat_cardset_t> discards, dw1, dw2;
+			std::vector<size_t> dwins, ddone;
+
+			struct job
+			{
+				skat_eval *eval;
+				skat_cardset_t cards;
+				size_t pos, min_wert, count;
+				unsigned long long deadline;
+			};
+
+			struct discard_job
+			{
+				skat_eval *eval;
+				size_t spiel, lead, discard, first, last;
+				unsigned long long deadline;
+			};
+
+			bool active
+				(const size_t c);
+			static void simulate
+				(void *arg, const size_t worker);
+			static void discard
+				(void *arg, const size_t worker);
+
+		public:
+			size_t samples, chunk, min_samples;
+			size_t max_samples;		// more samples, if time permits
+			const skat_model *model;	// drops hopeless candidates (optional)
+
+			skat_eval
+				(skat_pool &p, skat_tt *shared = NULL);
+			size_t evaluate
+				(const skat_cardset_t cards, const size_t pos,
+				const size_t min_wert, const unsigned long long deadline,
+				std::vector<skat_bid> &result);
+			skat_cardset_t druecken
+				(const skat_cardset_t cards, const size_t spiel,
+				const size_t pos, const unsigned long long deadline);
+			~skat_eval
+				();
+	};
+#endif
@@ -124,36 +124,273 @@ int skat_vkarte
 	}
 }
 
+static void skat_wipe
+	(std::string &s)
+{
+	std::fill(s.begin(), s.end(), 0);
+	s.clear();
+}
+
+// default handlers in a helper child, it must not stop the control program
+// (sig_handler_skat_quit) and is killed by the game process
+static void skat_kind_signale
+	()
+{
+	signal(SIGINT, SIG_DFL);
+	signal(SIGQUIT, SIG_DFL);
+	signal(SIGTERM, SIG_DFL);
+	signal(SIGPIPE, SIG_DFL);
+}
+
+// closes the inherited sockets and pipes except keep (in a helper child),
+// i.e. the table channels and the pipes of other children; devices (as the
+// random source of libgcrypt) and files remain open
+static void skat_kind_schliessen
+	(const std::vector<int> &keep)
+{
+	long max = sysconf(_SC_OPEN_MAX);
+	for (int fd = 3; fd < ((max > 0) ? max : 1024); fd++)
+	{
+		struct stat st;
+		if (std::find(keep.begin(), keep.end(), fd) != keep.end())
+			continue;
+		if (fstat(fd, &st) < 0)
+			continue;
+		if (S_ISSOCK(st.st_mode) || S_ISFIFO(st.st_mode))
+			close(fd);
+	}
+}
+
+// writes all bytes to a pipe (in a helper child)
+static bool skat_kind_schreiben
+	(int fd, const std::string &msg)
+{
+	size_t written = 0;
+	while (written < msg.length())
+	{
+		ssize_t num = write(fd, msg.c_str() + written, msg.length() - written);
+		if ((num < 0) && (errno != EINTR) && (errno != EAGAIN))
+			return false;
+		if (num > 0)
+			written += num;
+	}
+	return true;
+}
+
+skat_obeweise::skat_obeweise
+	():
+		pid(0), fd(-1), pending(0)
+{
+}
+
+void skat_obeweise::start
+	(SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf,
+	const TMCG_OpenStack<VTMF_Card> &os)
+{
+	int pipefd[2];
+	stop();
+	// the child is reaped by stop() only (no handler as sig_handler_chld)
+	signal(SIGCHLD, SIG_DFL);
+	if (pipe(pipefd) < 0)
+	{
+		perror("skat_obeweise::start (pipe)");
+		return;
+	}
+	if ((pid = fork()) < 0)
+	{
+		perror("skat_obeweise::start (fork)");
+		close(pipefd[0]), close(pipefd[1]);
+		pid = 0;
+		return;
+	}
+	if (pid == 0)
+	{
+		/* BEGIN child code (proofs) */
+		// libgcrypt mixes its random pool after fork(), thus the child does
+		// not reuse the randomness of the game process
+		skat_kind_signale();
+		close(pipefd[0]);
+		skat_kind_schliessen(std::vector<int>(1, pipefd[1]));
+		for (size_t i = 0; i < os.size(); i++)
+		{
+			std::stringstream proof;
+			tmcg->TMCG_ProveCardSecret(os[i].second, vtmf, proof, proof);
+			std::ostringstream ost;
+			ost << os[i].first << " " << proof.str().length() << std::endl <<
+				proof.str();
+			std::string msg = ost.str();
+			if (!skat_kind_schreiben(pipefd[1], msg))
+				_exit(1);
+			skat_wipe(msg);
+		}
+		close(pipefd[1]);
+		_exit(0);
+		/* END child code (proofs) */
+	}
+	close(pipefd[1]);
+	fd = pipefd[0];
+	for (size_t i = 0; i < os.size(); i++)
+		pending |= skat_card2set(os[i].first);
+}
+
+// reads the next part of the proofs (blocking); false, if the child is done
+bool skat_obeweise::receive
+	()
+{
+	if (fd < 0)
+		return false;
+	char tmp[4096];
+	ssize_t num = read(fd, tmp, sizeof(tmp));
+	if ((num < 0) && ((errno == EINTR) || (errno == EAGAIN)))
+		return true;
+	if (num <= 0)
+	{
+		close(fd);
+		fd = -1;
+		return false;
+	}
+	buffer.append(tmp, num);
+	memset(tmp, 0, sizeof(tmp));
+	// complete proofs of the buffer
+	size_t nl;
+	while ((nl = buffer.find('\n')) != buffer.npos)
+	{
+		size_t type = 0, size = 0;
+		std::istringstream ist(buffer.substr(0, nl));
+		ist >> type >> size;
+		if (!ist || (type > 31))
+		{
+			stop();
+			return false;
+		}
+		if (buffer.length() < (nl + 1 + size))
+			break;
+		proofs[type] = buffer.substr(nl + 1, size);
+		pending &= ~skat_card2set(type);
+		std::fill(buffer.begin(), buffer.begin() + nl + 1 + size, 0);
+		buffer.erase(0, nl + 1 + size);
+	}
+	return true;
+}
+
+// the cached proof for a card of the given type (waits for the child)
+bool skat_obeweise::take
+	(const size_t type, std::string &proof)
+{
+	while (proofs.find(type) == proofs.end())
+	{
+		if (!(pending & skat_card2set(type)) || !receive())
+			return false;
+	}
+	proof = proofs[type];
+	skat_wipe(proofs[type]);
+	proofs.erase(type);
+	return true;
+}
+
+void skat_obeweise::stop
+	()
+{
+	if (pid > 0)
+	{
+		kill(pid, SIGKILL);
+		while ((waitpid(pid, NULL, 0) < 0) && (errno == EINTR))
+			;
+		pid = 0;
+	}
+	if (fd >= 0)
+	{
+		close(fd);
+		fd = -1;
+	}
+	pending = 0;
+	skat_wipe(buffer);
+	for (std::map<size_t, std::string>::iterator pi = proofs.begin();
+		pi != proofs.end(); ++pi)
+			skat_wipe(pi->second);
+	proofs.clear();
+}
+
+skat_obeweise::~skat_obeweise
+	()
+{
+	stop();
+}
+
 void skat_okarte
 	(
 		SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf, const VTMF_Card &c,
-		iosecuresocketstream *right, iosecuresocketstream *left
+		iosecuresocketstream *right, iosecuresocketstream *left,
+		skat_obeweise *ob, const size_t type
 	)
 {
 #ifndef NDEBUG
 	start_clock();
 #endif
 	// use the non-interactiveness of the proof (only VTMF!)
-	std::stringstream proof;
-	tmcg->TMCG_ProveCardSecret(c, vtmf, proof, proof);
+	std::string proof;
+	if ((ob == NULL) || !ob->take(type, proof))
+	{
+		std::stringstream ps;
+		tmcg->TMCG_ProveCardSecret(c, vtmf, ps, ps);
+		proof = ps.str();
+	}
 	*right << c << std::endl << std::flush;
-	*right << proof.str() << std::flush;
+	*right << proof << std::flush;
 	*left << c << std::endl << std::flush;
-	*left << proof.str() << std::flush;
+	*left << proof << std::flush;
 #ifndef NDEBUG
 	stop_clock();
 	std::cerr << elapsed_time() << std::flush;
 #endif
 }
 
+// the proofs for all cards of a stack in one message (VTMF proofs are
+// non-interactive, cf. skat_okarte), i.e. one flush instead of one per line
+static void skat_beweise
+	(
+		SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf,
+		const TMCG_Stack<VTMF_Card> &s, iosecuresocketstream *out
+	)
+{
+	std::stringstream proof;
+	for (size_t i = 0; i < s.size(); i++)
+		tmcg->TMCG_ProveCardSecret(s[i], vtmf, proof, proof);
+	*out << proof.str() << std::flush;
+}
+
+// verifies the proofs of both neighbours for the own cards of a stack
+static bool skat_pruefen
+	(
+		SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf,
+		TMCG_OpenStack<VTMF_Card> &os, const TMCG_Stack<VTMF_Card> &s,
+		iosecuresocketstream *right, iosecuresocketstream *left
+	)
+{
+	for (size_t i = 0; i < s.size(); i++)
+		tmcg->TMCG_SelfCardSecret(s[i], vtmf);
+	for (size_t i = 0; i < s.size(); i++)
+	{
+		if (!tmcg->TMCG_VerifyCardSecret(s[i], vtmf, *left, *left))
+			return false;
+	}
+	for (size_t i = 0; i < s.size(); i++)
+	{
+		if (!tmcg->TMCG_VerifyCardSecret(s[i], vtmf, *right, *right))
+			return false;
+	}
+	for (size_t i = 0; i < s.size(); i++)
+		os.push(tmcg->TMCG_TypeOfCard(s[i], vtmf), s[i]);
+	return true;
+}
+
 void skat_szeigen
 	(
 		SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf,
 		const TMCG_Stack<VTMF_Card> &sk, iosecuresocketstream *rls
 	)
 {
-	for (size_t i = 0; i < sk.size(); i++)
-		tmcg->TMCG_ProveCardSecret(sk[i], vtmf, *rls, *rls);
+	skat_beweise(tmcg, vtmf, sk, rls);
 }
 
 bool skat_ssehen
@@ -163,35 +400,15 @@ bool skat_ssehen
 		iosecuresocketstream *right, iosecuresocketstream *left
 	)
 {
-	for (size_t i = 0; i < sk.size(); i++)
-	{
-		tmcg->TMCG_SelfCardSecret(sk[i], vtmf);
-		if (pkr_self == 0)
-		{
-			if (!tmcg->TMCG_VerifyCardSecret(sk[i], vtmf, *left, *left))
-				return false;
-			if (!tmcg->TMCG_VerifyCardSecret(sk[i], vtmf, *right, *right))
-				return false;
-		}
-		else if (pkr_self == 1)
-		{
-			if (!tmcg->TMCG_VerifyCardSecret(sk[i], vtmf, *left, *left))
-				return false;
-			if (!tmcg->TMCG_VerifyCardSecret(sk[i], vtmf, *right, *right))
-				return false;
-		}
-		else if (pkr_self == 2)
-		{
-			if (!tmcg->TMCG_VerifyCardSecret(sk[i], vtmf, *left, *left))
-				return false;
-			if (!tmcg->TMCG_VerifyCardSecret(sk[i], vtmf, *right, *right))
-				return false;
-		}
-		os.push(tmcg->TMCG_TypeOfCard(sk[i], vtmf), sk[i]);
-	}
-	return true;
+	if (pkr_self > 2)
+		return false;
+	return skat_pruefen(tmcg, vtmf, os, sk, right, left);
 }
 
+// Each player sends the proofs for the cards of both neighbours at once and
+// verifies the proofs for his own cards afterwards. Thus all players prove
+// in parallel and the deal needs a single flight of messages (the order of
+// the proofs on each connection is the same as for one proof per card).
 bool skat_sehen
 	(
 		size_t pkr_self, SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf,
@@ -202,51 +419,21 @@ bool skat_sehen
 {
 	if (pkr_self == 0)
 	{
-		for (size_t i = 0; i < s0.size(); i++)
-		{
-			tmcg->TMCG_SelfCardSecret(s0[i], vtmf);
-			if (!tmcg->TMCG_VerifyCardSecret(s0[i], vtmf, *left, *left))
-				return false;
-			if (!tmcg->TMCG_VerifyCardSecret(s0[i], vtmf, *right, *right))
-				return false;
-			os.push(tmcg->TMCG_TypeOfCard(s0[i], vtmf), s0[i]);
-		}
-		for (size_t i = 0; i < s1.size(); i++)
-			tmcg->TMCG_ProveCardSecret(s1[i], vtmf, *left, *left);
-		for (size_t i = 0; i < s2.size(); i++)
-			tmcg->TMCG_ProveCardSecret(s2[i], vtmf, *right, *right);
+		skat_beweise(tmcg, vtmf, s1, left);
+		skat_beweise(tmcg, vtmf, s2, right);
+		return skat_pruefen(tmcg, vtmf, os, s0, right, left);
 	}
 	if (pkr_self == 1)
 	{
-		for (size_t i = 0; i < s0.size(); i++)
-			tmcg->TMCG_ProveCardSecret(s0[i], vtmf, *right, *right);
-		for (size_t i = 0; i < s1.size(); i++)
-		{
-			tmcg->TMCG_SelfCardSecret(s1[i], vtmf);
-			if (!tmcg->TMCG_VerifyCardSecret(s1[i], vtmf, *right, *right))
-				return false;
-			if (!tmcg->TMCG_VerifyCardSecret(s1[i], vtmf, *left, *left))
-				return false;
-			os.push(tmcg->TMCG_TypeOfCard(s1[i], vtmf), s1[i]);
-		}
-		for (size_t i = 0; i < s2.size(); i++)
-			tmcg->TMCG_ProveCardSecret(s2[i], vtmf, *left, *left);
+		skat_beweise(tmcg, vtmf, s0, right);
+		skat_beweise(tmcg, vtmf, s2, left);
+		return skat_pruefen(tmcg, vtmf, os, s1, right, left);
 	}
 	if (pkr_self == 2)
 	{
-		for (size_t i = 0; i < s0.size(); i++)
-			tmcg->TMCG_ProveCardSecret(s0[i], vtmf, *left, *left);
-		for (size_t i = 0; i < s1.size(); i++)
-			tmcg->TMCG_ProveCardSecret(s1[i], vtmf, *right, *right);
-		for (size_t i = 0; i < s2.size(); i++)
-		{
-			tmcg->TMCG_SelfCardSecret(s2[i], vtmf);
-			if (!tmcg->TMCG_VerifyCardSecret(s2[i], vtmf, *left, *left))
-				return false;
-			if (!tmcg->TMCG_VerifyCardSecret(s2[i], vtmf, *right, *right))
-				return false;
-			os.push(tmcg->TMCG_TypeOfCard(s2[i], vtmf), s2[i]);
-		}
+		skat_beweise(tmcg, vtmf, s0, left);
+		skat_beweise(tmcg, vtmf, s1, right);
+		return skat_pruefen(tmcg, vtmf, os, s2, right, left);
 	}
 	return true;
 }
@@ -363,18 +550,33 @@ bool skat_mischen_beweis
 	return true;
 }
 
+// masking values of the pool, if any, otherwise by TMCG_MixStack
+static void skat_mischen_stapel
+	(
+		SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf,
+		skat_mask_pool *pool, const TMCG_Stack<VTMF_Card> &s,
+		TMCG_Stack<VTMF_Card> &s2, TMCG_StackSecret<VTMF_CardSecret> &ss
+	)
+{
+	if ((pool != NULL) && (pool->size() > 0))
+		pool->mix(s, s2, ss);
+	else
+		tmcg->TMCG_MixStack(s, s2, ss, vtmf);
+}
+
 bool skat_mischen
 	(
 		size_t pkr_self, SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf,
-		const TMCG_Stack<VTMF_Card> &d, const TMCG_StackSecret<VTMF_CardSecret> &ss,
+		const TMCG_Stack<VTMF_Card> &d, TMCG_StackSecret<VTMF_CardSecret> &ss,
 		TMCG_Stack<VTMF_Card> &d0, TMCG_Stack<VTMF_Card> &d1,
 		TMCG_Stack<VTMF_Card> &d2,
-		iosecuresocketstream *right, iosecuresocketstream *left
+		iosecuresocketstream *right, iosecuresocketstream *left,
+		skat_mask_pool *pool
 	)
 {
 	if (pkr_self == 0)
 	{
-		tmcg->TMCG_MixStack(d, d0, ss, vtmf);
+		skat_mischen_stapel(tmcg, vtmf, pool, d, d0, ss);
 		*right << d0 << std::endl << std::flush;
 		*left << d0 << std::endl << std::flush;
 		*left >> d1;
@@ -389,7 +591,7 @@ bool skat_mischen
 		*right >> d0;
 		if (!right->good())
 			return false;
-		tmcg->TMCG_MixStack(d0, d1, ss, vtmf);
+		skat_mischen_stapel(tmcg, vtmf, pool, d0, d1, ss);
 		*right << d1 << std::endl << std::flush;
 		*left << d1 << std::endl << std::flush;
 		*left >> d2;
@@ -404,7 +606,7 @@ bool skat_mischen
 		*right >> d1;
 		if (!right->good())
 			return false;
-		tmcg->TMCG_MixStack(d1, d2, ss, vtmf);
+		skat_mischen_stapel(tmcg, vtmf, pool, d1, d2, ss);
 		*right << d2 << std::endl << std::flush;
 		*left << d2 << std::endl << std::flush;
 	}
@@ -414,6 +616,214 @@ bool skat_mischen
 	return true;
 }
 
+int skat_mischen_spiel
+	(
+		size_t pkr_self, SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf,
+		GrothVSSHE *vsshe, TMCG_Stack<VTMF_Card> &d_end,
+		iosecuresocketstream *right, iosecuresocketstream *left,
+		skat_mask_pool *pool
+	)
+{
+	// create the deck (containing 32 different cards)
+	TMCG_OpenStack<VTMF_Card> d;
+	for (int i = 0; i < 32; i++)
+	{
+		VTMF_Card c;
+		tmcg->TMCG_CreateOpenCard(c, vtmf, i);
+		d.push(i, c);
+	}
+	// shuffle the deck
+	TMCG_Stack<VTMF_Card> d2, d_mix[3];
+	TMCG_StackSecret<VTMF_CardSecret> ss;
+	d2.push(d);
+	tmcg->TMCG_CreateStackSecret(ss, false, d2.size(), vtmf);
+	if (!skat_mischen(pkr_self, tmcg, vtmf, d2, ss, d_mix[0], d_mix[1],
+		d_mix[2], right, left, pool))
+	{
+		return 1;
+	}
+	if (!skat_mischen_beweis(pkr_self, tmcg, vtmf, vsshe, d2, ss,
+		d_mix[0], d_mix[1], d_mix[2], right, left))
+	{
+		return 2;
+	}
+	d_end = d_mix[2];
+	return 0;
+}
+
+static void skat_mask_statistik
+	(const skat_mask_pool &pool)
+{
+#ifndef NDEBUG
+	unsigned long n = pool.hits + pool.dry;
+	std::cerr << "skat_mask_pool: " << pool.hits << " hits, " << pool.dry <<
+		" dry (" << ((n > 0) ? ((100 * pool.hits) / n) : 0) << "% hit rate)" <<
+		std::endl;
+#endif
+}
+
+skat_mischer::skat_mischer
+	():
+		pid(0), fd_deck(-1), fd_next(-1), in(NULL), games(0)
+{
+}
+
+bool skat_mischer::start
+	(size_t pkr_self, SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf,
+	GrothVSSHE *vsshe, const size_t n,
+	iosecuresocketstream *right, iosecuresocketstream *left)
+{
+	int deckfd[2], nextfd[2];
+	stop();
+	if ((right == NULL) || (left == NULL) || (n == 0))
+		return false;
+	// the child is reaped by stop() only, as for skat_obeweise
+	signal(SIGCHLD, SIG_DFL);
+	if (pipe(deckfd) < 0)
+	{
+		perror("skat_mischer::start (pipe)");
+		return false;
+	}
+	if (pipe(nextfd) < 0)
+	{
+		perror("skat_mischer::start (pipe)");
+		close(deckfd[0]), close(deckfd[1]);
+		return false;
+	}
+	if ((pid = fork()) < 0)
+	{
+		perror("skat_mischer::start (fork)");
+		close(deckfd[0]), close(deckfd[1]);
+		close(nextfd[0]), close(nextfd[1]);
+		pid = 0;
+		return false;
+	}
+	if (pid == 0)
+	{
+		/* BEGIN child code (shuffle) */
+		// fresh randomness after fork() as for skat_obeweise
+		skat_kind_signale();
+		close(deckfd[0]), close(nextfd[1]);
+		std::vector<int> keep;
+		keep.push_back(deckfd[1]), keep.push_back(nextfd[0]);
+		keep.push_back(right->handle()), keep.push_back(left->handle());
+		skat_kind_schliessen(keep);
+		int status = 0;
+		{
+			// the masking values are computed while the game is played
+			size_t ms, mt, mm;
+			skat_mask_config(ms, mt, mm);
+			skat_mask_pool pool(vtmf, ms, mt, mm);
+			for (size_t g = 0; g < n; g++)
+			{
+				char go = 0;
+				// the previous deck must be taken by the game process first
+				if (g > 0)
+				{
+					ssize_t num;
+					do
+						num = read(nextfd[0], &go, 1);
+					while ((num < 0) && (errno == EINTR));
+					if (num <= 0)
+						break;
+				}
+				TMCG_Stack<VTMF_Card> d_end;
+				int error = skat_mischen_spiel(pkr_self, tmcg, vtmf, vsshe, d_end,
+					right, left, &pool);
+				std::ostringstream ost;
+				ost << error << std::endl;
+				if (error == 0)
+					ost << d_end << std::endl;
+				if (!skat_kind_schreiben(deckfd[1], ost.str()) || error)
+				{
+					status = 1;
+					break;
+				}
+			}
+			skat_mask_statistik(pool);
+		}
+		_exit(status);
+		/* END child code (shuffle) */
+	}
+	close(deckfd[1]), close(nextfd[0]);
+	fd_deck = deckfd[0], fd_next = nextfd[1], games = n;
+	in = new ipipestream(fd_deck);
+	return true;
+}
+
+bool skat_mischer::running
+	() const
+{
+	return (pid > 0);
+}
+
+int skat_mischer::next
+	(TMCG_Stack<VTMF_Card> &d_end)
+{
+	if ((in == NULL) || (games == 0))
+		return 3;
+	int error = 3;
+	*in >> error;
+	in->ignore(1, '\n');
+	if (!in->good())
+		return 3;
+	if (error)
+		return error;
+	*in >> d_end;
+	if (!in->good())
+		return 3;
+	// the child shuffles the next deck while this game is played
+	if (--games > 0)
+	{
+		char go = 1;
+		ssize_t num;
+		// a dead child must not raise SIGPIPE (sig_handler_skat_quit), it is
+		// noticed by the next call instead
+		void (*handler)(int) = signal(SIGPIPE, SIG_IGN);
+		do
+			num = write(fd_next, &go, 1);
+		while ((num < 0) && (errno == EINTR));
+		signal(SIGPIPE, handler);
+		if (num != 1)
+			perror("skat_mischer::next (write)");
+	}
+	return 0;
+}
+
+void skat_mischer::stop
+	()
+{
+	if (pid > 0)
+	{
+		kill(pid, SIGKILL);
+		while ((waitpid(pid, NULL, 0) < 0) && (errno == EINTR))
+			;
+		pid = 0;
+	}
+	if (in != NULL)
+	{
+		delete in;
+		in = NULL;
+	}
+	if (fd_deck >= 0)
+	{
+		close(fd_deck);
+		fd_deck = -1;
+	}
+	if (fd_next >= 0)
+	{
+		close(fd_next);
+		fd_next = -1;
+	}
+	games = 0;
+}
+
+skat_mischer::~skat_mischer
+	()
+{
+	stop();
+}
+
 bool game_helper_1
 	(size_t &reiz_status, size_t &spiel_allein, size_t vh, size_t mh, size_t hh,
 	size_t reiz_counter, size_t pkr_self, const std::vector<std::string> &nicks,
@@ -473,6 +883,7 @@ int skat_game
 		int ipipe, int ctl_o, int ctl_i, SchindelhauerTMCG *tmcg,
 		TMCG_PublicKeyRing &pkr, const TMCG_SecretKey &sec,
 		iosecuresocketstream *right, iosecuresocketstream *left,
+		iosecuresocketstream *right_mix, iosecuresocketstream *left_mix,
 		const std::vector<std::string> &nicks, int hpipe, bool pctl,
 		char *ireadbuf, size_t &ireaded,
 		std::string main_channel, std::string main_channel_underscore
@@ -686,6 +1097,15 @@ int skat_game
 	std::cerr << "KeyGenerationProtocol2b: " << elapsed_time() << std::endl;
 #endif
 	
+	// all neighbours have separate channels: shuffle the decks in advance
+	skat_mischer mischer;
+	mischer.start(pkr_self, tmcg, vtmf, vsshe, 3 * rounds, right_mix, left_mix);
+	
+	// otherwise the masking values are computed in advance by this process
+	size_t ms, mt, mm;
+	skat_mask_config(ms, mt, mm);
+	skat_mask_pool masken(vtmf, (mischer.running()) ? 0 : ms, mt, mm);
+	
 	// loop the given number of rounds
 	for (size_t r = 0; r < rounds; r++)
 	{
@@ -697,19 +1117,8 @@ int skat_game
 		// play three games in each round
 		for (size_t p = 0; p < 3; p++)
 		{
-			// create the deck (containing 32 different cards)
-			TMCG_OpenStack<VTMF_Card> d;
-			for (int i = 0; i < 32; i++)
-			{
-				VTMF_Card c;
-				tmcg->TMCG_CreateOpenCard(c, vtmf, i);
-				d.push(i, c);
-			}
-			// shuffle the deck
-			TMCG_Stack<VTMF_Card> d2, d_mix[3], d_end;
-			TMCG_StackSecret<VTMF_CardSecret> ss, ab;
-			d2.push(d);
-			tmcg->TMCG_CreateStackSecret(ss, false, d2.size(), vtmf);
+			// shuffle the deck (in advance by the child, if pipelined)
+			TMCG_Stack<VTMF_Card> d_end;
 			std::cout << "><>< " << _("Shuffle the cards.") << " " << _("Please wait") << "." << std::flush;
 			if (pctl)
 			{
@@ -720,8 +1129,14 @@ int skat_game
 #ifndef NDEBUG
 			start_clock();
 #endif
-			if (!skat_mischen(pkr_self, tmcg, vtmf, d2, ss, d_mix[0], d_mix[1],
-				d_mix[2], right, left))
+			int mix_error = (mischer.running()) ? mischer.next(d_end) :
+				skat_mischen_spiel(pkr_self, tmcg, vtmf, vsshe, d_end, right, left,
+					&masken);
+#ifndef NDEBUG
+			stop_clock();
+			std::cerr << elapsed_time() << std::flush;
+#endif
+			if (mix_error == 1)
 			{
 				std::cout << ">< " << _("shuffling error") << ": " << _("bad stack format") << std::endl;
 				delete vsshe;
@@ -731,16 +1146,7 @@ int skat_game
 				delete out_pipe;
 				return 1;
 			}
-#ifndef NDEBUG
-			stop_clock();
-			std::cerr << elapsed_time() << std::flush;
-#endif
-			std::cout << "." << std::flush;
-#ifndef NDEBUG
-			start_clock();
-#endif
-			if (!skat_mischen_beweis(pkr_self, tmcg, vtmf, vsshe, d2, ss,
-				d_mix[0], d_mix[1], d_mix[2], right, left))
+			if (mix_error == 2)
 			{
 				std::cout << ">< " << _("shuffling error") << ": " << _("wrong ZK proof") << std::endl;
 				delete vsshe;
@@ -750,12 +1156,17 @@ int skat_game
 				delete out_pipe;
 				return 2;
 			}
-#ifndef NDEBUG
-			stop_clock();
-			std::cerr << elapsed_time() << std::flush;
-#endif
-			std::cout << "." << _("finished!") << std::endl;
-			d_end = d_mix[2];
+			if (mix_error)
+			{
+				std::cout << ">< " << _("connection with participating player(s) collapsed") << std::endl;
+				delete vsshe;
+				delete vtmf;
+				if (pctl)
+					delete out_ctl;
+				delete out_pipe;
+				return 5;
+			}
+			std::cout << ".." << _("finished!") << std::endl;
 
 			
 			// compute unique game ID (aka hex_game_digest)
@@ -813,6 +1224,11 @@ int skat_game
 			std::cerr << elapsed_time() << std::flush;
 #endif
 			std::cout << "." << _("finished!") << std::endl;
+			// proofs for playing the own cards (computed while bidding)
+			skat_obeweise ob;
+			masken.pause();
+			ob.start(tmcg, vtmf, os);
+			masken.resume();
 			for (size_t i = 0; pctl && (i < os.size()); i++)
 			{
 				std::ostringstream ost;
@@ -1854,7 +2270,8 @@ int skat_game
 														nr << " :OUVERT " << 
 														skat_type2string(os[i].first) << " " << 
 														hex_game_digest << std::endl << std::flush;
-													skat_okarte(tmcg, vtmf, os[i].second, right, left);
+													skat_okarte(tmcg, vtmf, os[i].second, right, left,
+														&ob, os[i].first);
 													// sleep few seconds to prevent "Excess Flood" error
 													sleep(3);
 												}
@@ -1908,7 +2325,8 @@ int skat_game
 									{
 										// Regelkontrolle, falls schon Karten gespielt sind
 										if ((os_sp.size() > 0) &&
-											(!skat_rulectl(os_sp[0].first, tt, spiel_status, os)))
+											!(skat_legal(os_sp[0].first, spiel_status,
+												skat_stack2cardset(os)) & skat_card2set(tt)))
 										{
 											std::cout << ">< " << _("playing the card") << " \"" << 
 												par << "\" " << _("is not conform with the rules") << 
@@ -1931,7 +2349,7 @@ int skat_game
 										VTMF_Card c;
 										os.move(tt, st);
 										assert(st.size() == 1);
-										skat_okarte(tmcg, vtmf, st[0], right, left);
+										skat_okarte(tmcg, vtmf, st[0], right, left, &ob, tt);
 										s[pkr_self].remove(st[0]);
 										tmcg->TMCG_CreateOpenCard(c, vtmf, tt);
 										os_sp.push(tt, c);
@@ -2047,20 +2465,17 @@ int skat_game
 						&& (os_pkt[spiel_allein].size() != 0)));
 				for (size_t i = 0; i < 3; i++)
 				{
-					TMCG_OpenStack<VTMF_Card> gps;
 					assert((os_rc[i].size() == 10) ||
 						((skat_spiel2gwert(spiel_status) == 23)
 							&& (os_pkt[spiel_allein].size() != 0)));
-					gps.push(os_rc[i]);
+					skat_cardset_t gps = skat_stack2cardset(os_rc[i]);
 					rules_ok[i] = true;
 					for (size_t j = 0; j < os_st.size(); j++)
 					{
-						if (!skat_rulectl(os_st[j].first,
-							os_rc[i][j].first, spiel_status, gps))
-						{
+						skat_cardset_t cc = skat_card2set(os_rc[i][j].first);
+						if (!(skat_legal(os_st[j].first, spiel_status, gps) & cc))
 							rules_ok[i] = false;
-						}
-						gps.remove(os_rc[i][j].first);
+						gps &= ~cc;
 					}
 				}
 				
@@ -2225,14 +2640,9 @@ int skat_game
 				os_pkt[i].clear();
 				os_rc[i].clear();
 				s[i].clear();
-				d_mix[i].clear();
 			}
 			sk.clear();
 			d_end.clear();
-			ab.clear();
-			ss.clear();
-			d2.clear();
-			d.clear();
 			
 			std::cout << "><><>< " << _("game result") << " <><><> ";
 			for (size_t i = 0; i < 3; i++)
@@ -2359,6 +2769,8 @@ int skat_game
 		delete [] hex_rnk_digest;
 		delete npipe;
 	}
+	if (masken.size() > 0)
+		skat_mask_statistik(masken);
 	delete vsshe;
 	delete vtmf;
 	if (pctl)
@@ -24,6 +24,7 @@
 	#include "SecureSkat_defs.hh"
 	#include "SecureSkat_misc.hh"
 	#include "SecureSkat_rule.hh"
+	#include "SecureSkat_mask.hh"
 		
 	int skat_vkarte
 		(
@@ -32,10 +33,43 @@
 			iosecuresocketstream *right, iosecuresocketstream *left, bool rmv
 		);
 	
+	// Proofs for the own cards (TMCG_ProveCardSecret, non-interactive with
+	// VTMF) are computed by a child process as soon as the cards are dealt,
+	// thus playing a card only sends the cached proof. The child writes the
+	// proofs as "type size" and size bytes to a pipe, the game process reads
+	// them when needed. Cached proofs reveal the cards, therefore they are
+	// overwritten when the game ends (stop or destructor).
+	class skat_obeweise
+	{
+		private:
+			pid_t pid;
+			int fd;
+			skat_cardset_t pending;	// cards with a proof still to be read
+			std::string buffer;
+			std::map<size_t, std::string> proofs;
+
+			bool receive
+				();
+
+		public:
+			skat_obeweise
+				();
+			void start
+				(SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf,
+				const TMCG_OpenStack<VTMF_Card> &os);
+			bool take
+				(const size_t type, std::string &proof);
+			void stop
+				();
+			~skat_obeweise
+				();
+	};
+
 	void skat_okarte
 		(
 			SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf, const VTMF_Card &c,
-			iosecuresocketstream *right, iosecuresocketstream *left
+			iosecuresocketstream *right, iosecuresocketstream *left,
+			skat_obeweise *ob = NULL, const size_t type = 0
 		);
 	
 	void skat_szeigen
@@ -80,18 +114,64 @@
 		(
 			size_t pkr_self, SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf,
 			const TMCG_Stack<VTMF_Card> &d,
-			const TMCG_StackSecret<VTMF_CardSecret> &ss,
+			TMCG_StackSecret<VTMF_CardSecret> &ss,
 			TMCG_Stack<VTMF_Card> &d0, TMCG_Stack<VTMF_Card> &d1,
 			TMCG_Stack<VTMF_Card> &d2,
-			iosecuresocketstream *right, iosecuresocketstream *left
+			iosecuresocketstream *right, iosecuresocketstream *left,
+			skat_mask_pool *pool
 		);
 	
+	// creates, shuffles and proves the deck of a game (0 = shuffled,
+	// 1 = bad stack format, 2 = wrong ZK proof); the own masking values are
+	// taken from pool, if it is not NULL
+	int skat_mischen_spiel
+		(
+			size_t pkr_self, SchindelhauerTMCG *tmcg, BarnettSmartVTMF_dlog *vtmf,
+			GrothVSSHE *vsshe, TMCG_Stack<VTMF_Card> &d_end,
+			iosecuresocketstream *right, iosecuresocketstream *left,
+			skat_mask_pool *pool
+		);
+
+	// Pipelined dealing: a child process shuffles the decks of all games
+	// (skat_mischen_spiel) on separate channels to the neighbours. It sends
+	// each deck through a pipe and starts with the next one as soon as the
+	// game process has taken it, i.e. while the game is played. There is no
+	// inline fallback once the child runs: if it fails, the table is
+	// aborted, because the neighbours cannot switch to another deck.
+	class skat_mischer
+	{
+		private:
+			pid_t pid;
+			int fd_deck, fd_next;
+			ipipestream *in;
+			size_t games;
+
+		public:
+			skat_mischer
+				();
+			bool start
+				(size_t pkr_self, SchindelhauerTMCG *tmcg,
+				BarnettSmartVTMF_dlog *vtmf, GrothVSSHE *vsshe, const size_t n,
+				iosecuresocketstream *right, iosecuresocketstream *left);
+			bool running
+				() const;
+			// the deck of the next game (result as skat_mischen_spiel, 3 if
+			// the child has failed)
+			int next
+				(TMCG_Stack<VTMF_Card> &d_end);
+			void stop
+				();
+			~skat_mischer
+				();
+	};
+
 	int skat_game
 		(
 			std::string nr, size_t rounds, size_t pkr_self, bool master, int opipe,
 			int ipipe, int ctl_o, int ctl_i, SchindelhauerTMCG *tmcg,
 			TMCG_PublicKeyRing &pkr, const TMCG_SecretKey &sec,
 			iosecuresocketstream *right, iosecuresocketstream *left,
+			iosecuresocketstream *right_mix, iosecuresocketstream *left_mix,
 			const std::vector<std::string> &nicks, int hpipe, bool pctl,
 			char *ireadbuf, size_t &ireaded,
 			std::string main_channel, std::string main_channel_underscore
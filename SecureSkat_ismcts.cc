@@ -0,0 +1,241 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_ismcts.hh"
+
+#define SKAT_ISMCTS_NONE	((size_t)-1)
+
+skat_ismcts::skat_ismcts
+	(skat_pool &p):
+		pool(p), exploration(0.7), iterations(0), max_iterations(200000),
+		max_nodes(1 << 20), playouts(8)
+{
+	tree.resize(pool.size());
+	done.resize(pool.size());
+	for (size_t i = 0; i < pool.size(); i++)
+	{
+		state.push_back((((unsigned long long)tmcg_mpz_wrandom_ui()) << 32) ^
+			tmcg_mpz_wrandom_ui() ^ (i + 1));
+	}
+}
+
+// simulation: k random games from the position p in lockstep (one card of
+// each game per step); returns the mean result of the declarer, where the
+// win counts and the card points distinguish between the wins and between
+// the losses
+double skat_ismcts::playout
+	(const skat_position &p, const size_t k, unsigned long long &rs)
+{
+	skat_cardset_t hand[3][SKAT_ISMCTS_BATCH], trick[3][SKAT_ISMCTS_BATCH];
+	skat_cardset_t cur[SKAT_ISMCTS_BATCH], legal[SKAT_ISMCTS_BATCH];
+	skat_cardset_t none[SKAT_ISMCTS_BATCH];
+	uint32_t lead[SKAT_ISMCTS_BATCH], augen[SKAT_ISMCTS_BATCH];
+	uint32_t lost[SKAT_ISMCTS_BATCH], winner[SKAT_ISMCTS_BATCH];
+	uint32_t points[SKAT_ISMCTS_BATCH];
+	bool null = ((p.spiel % 100) == 23);
+	size_t len = p.trick_len;
+	size_t rest = skat_cardset_size(p.hand[0] | p.hand[1] | p.hand[2]);
+	for (size_t i = 0; i < k; i++)
+	{
+		for (size_t j = 0; j < 3; j++)
+		{
+			hand[j][i] = p.hand[j];
+			trick[j][i] = (j < len) ? skat_card2set(p.trick[j]) : 0;
+		}
+		none[i] = 0, lead[i] = p.lead, augen[i] = p.augen;
+		lost[i] = (p.null_lost) ? 1 : 0;
+	}
+	for (; rest > 0; rest--)
+	{
+		for (size_t i = 0; i < k; i++)
+			cur[i] = hand[(lead[i] + len) % 3][i];
+		skat_batch_legal(p.spiel, (len > 0) ? trick[0] : none, cur, k, legal);
+		for (size_t i = 0; i < k; i++)
+		{
+			skat_cardset_t c = legal[i];
+			size_t n = skat_random(rs) % skat_cardset_size(c);
+			while (n--)
+				c &= (c - 1);
+			c &= (0 - c);
+			hand[(lead[i] + len) % 3][i] &= ~c;
+			trick[len][i] = c;
+		}
+		if (++len < 3)
+			continue;
+		skat_batch_bstich(p.spiel, trick[0], trick[1], trick[2], k, winner);
+		for (size_t i = 0; i < k; i++)
+			cur[i] = trick[0][i] | trick[1][i] | trick[2][i];
+		skat_batch_augen(cur, k, points);
+		for (size_t i = 0; i < k; i++)
+		{
+			uint32_t w = (lead[i] + winner[i]) % 3;
+			if (w == p.declarer)
+				augen[i] += points[i], lost[i] = 1;
+			lead[i] = w;
+		}
+		len = 0;
+	}
+	double r = 0.0;
+	for (size_t i = 0; i < k; i++)
+	{
+		if (null)
+			r += (lost[i]) ? 0.0 : 1.0;
+		else
+			r += 0.9 * ((augen[i] > 60) ? 1.0 : 0.0) + 0.1 * (augen[i] / 120.0);
+	}
+	return r / k;
+}
+
+static inline bool skat_ismcts_finished
+	(const skat_position &p)
+{
+	if (((p.spiel % 100) == 23) && p.null_lost)
+		return true;
+	return ((p.hand[0] | p.hand[1] | p.hand[2]) == 0);
+}
+
+// each job has its own tree, since a worker may execute several jobs
+void skat_ismcts::search
+	(void *arg, const size_t)
+{
+	job *j = (job*)arg;
+	skat_ismcts *mc = j->mcts;
+	std::vector<node> &t = mc->tree[j->id];
+	unsigned long long &rs = mc->state[j->id];
+	std::vector<size_t> path;
+	node root;
+	root.card = 99, root.player = 99, root.visits = 0, root.avail = 0;
+	root.reward = 0.0, root.child = SKAT_ISMCTS_NONE;
+	root.sibling = SKAT_ISMCTS_NONE;
+	t.clear();
+	t.push_back(root);
+	mc->done[j->id] = 0;
+	for (unsigned long it = 0; it < mc->max_iterations; it++)
+	{
+		if (((it & 15) == 0) && j->deadline && (skat_msec() > j->deadline))
+			break;
+		skat_position p;
+		if (!skat_infoset_sample(*j->is, p, rs))
+			break;
+		// selection and expansion in the tree of this determinization
+		size_t n = 0;
+		path.clear();
+		path.push_back(0);
+		while (!skat_ismcts_finished(p))
+		{
+			size_t mover = (p.lead + p.trick_len) % 3;
+			size_t tc = (p.trick_len > 0) ? p.trick[0] : 99;
+			skat_cardset_t legal = skat_legal(tc, p.spiel, p.hand[mover]);
+			skat_cardset_t untried = legal;
+			size_t best = SKAT_ISMCTS_NONE;
+			double best_value = -1.0;
+			for (size_t c = t[n].child; c != SKAT_ISMCTS_NONE; c = t[c].sibling)
+			{
+				if (!(legal & skat_card2set(t[c].card)))
+					continue;
+				untried &= ~skat_card2set(t[c].card);
+				t[c].avail++;
+				double v = (t[c].reward / t[c].visits) + mc->exploration *
+					sqrt(log((double)t[c].avail) / t[c].visits);
+				if (v > best_value)
+					best_value = v, best = c;
+			}
+			if (untried && (t.size() < mc->max_nodes))
+			{
+				// expansion: add a random untried card
+				std::vector<size_t> uv;
+				skat_cardset2vector(untried, uv);
+				node e;
+				e.card = uv[skat_random(rs) % uv.size()], e.player = mover;
+				e.visits = 0, e.avail = 1, e.reward = 0.0;
+				e.child = SKAT_ISMCTS_NONE, e.sibling = t[n].child;
+				t.push_back(e);
+				t[n].child = t.size() - 1;
+				n = t.size() - 1;
+				path.push_back(n);
+				skat_position_play(p, e.card);
+				break;
+			}
+			if (best == SKAT_ISMCTS_NONE)
+				break;
+			n = best;
+			path.push_back(n);
+			skat_position_play(p, t[n].card);
+		}
+		// simulation: a batch of random games until the end
+		size_t k = std::min(std::max(mc->playouts, (size_t)1),
+			(size_t)SKAT_ISMCTS_BATCH);
+		double r = (skat_ismcts_finished(p)) ? playout(p, 1, rs) :
+			playout(p, k, rs);
+		// backpropagation
+		for (size_t i = 0; i < path.size(); i++)
+		{
+			node &v = t[path[i]];
+			v.visits++;
+			if (i > 0)
+				v.reward += (v.player == p.declarer) ? r : (1.0 - r);
+		}
+		mc->done[j->id]++;
+	}
+}
+
+// returns the allowed cards and the number of visits for each of them
+size_t skat_ismcts::decide
+	(const skat_infoset &is, const unsigned long long deadline,
+	std::vector<size_t> &mv, std::vector<size_t> &result)
+{
+	size_t t = (is.trick_len > 0) ? is.trick[0] : 99;
+	skat_cardset2vector(skat_legal(t, is.spiel, is.hand[is.self]), mv);
+	result.assign(mv.size(), 0);
+	iterations = 0;
+	if (mv.size() < 2)
+		return mv.size();
+	std::vector<job> jobs(pool.size());
+	for (size_t i = 0; i < pool.size(); i++)
+	{
+		jobs[i].mcts = this, jobs[i].is = &is, jobs[i].id = i;
+		jobs[i].deadline = deadline;
+		pool.submit(search, &jobs[i], i);
+	}
+	pool.wait();
+	// root parallelization: sum up the visits of all trees
+	for (size_t i = 0; i < pool.size(); i++)
+	{
+		std::vector<node> &tr = tree[i];
+		iterations += done[i];
+		if (tr.size() == 0)
+			continue;
+		for (size_t c = tr[0].child; c != SKAT_ISMCTS_NONE; c = tr[c].sibling)
+		{
+			for (size_t k = 0; k < mv.size(); k++)
+			{
+				if (mv[k] == tr[c].card)
+					result[k] += tr[c].visits;
+			}
+		}
+	}
+	return mv.size();
+}
+
+skat_ismcts::~skat_ismcts
+	()
+{
+	tree.clear();
+}
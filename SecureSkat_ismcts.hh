@@ -0,0 +1,83 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_ismcts_HH
+	#define INCLUDED_SecureSkat_ismcts_HH
+
+	#include "SecureSkat_defs.hh"
+	#include "SecureSkat_rule.hh"
+	#include "SecureSkat_search.hh"
+	#include "SecureSkat_pool.hh"
+	#include "SecureSkat_pimc.hh"
+
+	// maximum number of random games (playouts) from a leaf in one batch
+	#define SKAT_ISMCTS_BATCH	64
+
+	// Information Set Monte Carlo Tree Search (single observer): each
+	// iteration samples a world of the information set, but all iterations
+	// share one tree of card sequences, i.e., the statistics are collected
+	// for the information set and not for single worlds as in PIMC; the
+	// workers build separate trees (root parallelization). The leaf of an
+	// iteration is evaluated by a batch of random games (leaf parallelization
+	// with the batch kernels of SecureSkat_rule).
+	class skat_ismcts
+	{
+		private:
+			struct node
+			{
+				size_t card, player;		// move that leads to this node
+				unsigned long visits, avail;
+				double reward;				// sum for player of the move
+				size_t child, sibling;		// first child and next sibling
+			};
+
+			struct job
+			{
+				skat_ismcts *mcts;
+				const skat_infoset *is;
+				size_t id;
+				unsigned long long deadline;
+			};
+
+			skat_pool &pool;
+			std::vector< std::vector<node> > tree;
+			std::vector<unsigned long long> state;
+			std::vector<unsigned long> done;
+
+			static double playout
+				(const skat_position &p, const size_t k,
+				unsigned long long &rs);
+			static void search
+				(void *arg, const size_t worker);
+
+		public:
+			double exploration;
+			unsigned long iterations, max_iterations;
+			size_t max_nodes, playouts;
+
+			skat_ismcts
+				(skat_pool &p);
+			size_t decide
+				(const skat_infoset &is, const unsigned long long deadline,
+				std::vector<size_t> &mv, std::vector<size_t> &result);
+			~skat_ismcts
+				();
+	};
+#endif
@@ -0,0 +1,413 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_learn.hh"
+
+static const size_t skat_learn_spiele[] = { 9, 10, 11, 12, 24, 23 };
+
+size_t skat_learn_kind
+	(
+		const size_t spiel
+	)
+{
+	switch (spiel % 100)
+	{
+		case 23:
+			return SKAT_LEARN_NULL;
+		case 24:
+			return SKAT_LEARN_GRAND;
+		default:
+			return SKAT_LEARN_SUIT;
+	}
+}
+
+// features of a trump game (suit game or Grand)
+static void skat_learn_trump
+	(const size_t spiel, const skat_cardset_t cs, const size_t pos,
+	float *x)
+{
+	skat_cardset_t tm = skat_trumpmask(spiel), rows[4] = { 0, 0, 0, 0 };
+	size_t trumps = skat_cardset_size(cs & tm), high = 0;
+	size_t aces = 0, tens_a = 0, tens = 0, kings = 0;
+	for (size_t c = 0; c < 32; c++)
+	{
+		skat_cardset_t cm = skat_card2set(c);
+		if (cm & tm)
+		{
+			size_t rank = skat_cardrank(spiel, c);
+			if (!(cs & cm))
+				continue;
+			if (c < 4)
+				x[2 + c] = 1.0f;
+			else if (rank == 4)
+				x[6] = 1.0f;
+			else if (rank == 5)
+				x[7] = 1.0f;
+			if (rank < 6)
+				high++;
+			continue;
+		}
+		rows[skat_cardrow(spiel, c)] |= cm;
+		if (!(cs & cm))
+			continue;
+		if (skat_pktwert[c] == 11)
+			aces++;
+		else if ((skat_pktwert[c] == 10) && (cs & skat_card2set(c - 1)))
+			tens_a++;
+		else if (skat_pktwert[c] == 10)
+			tens++;
+		else if (skat_pktwert[c] == 4)
+			kings++;
+	}
+	size_t voids = 0, singletons = 0, longest = 0, side = 0;
+	for (size_t r = 0; r < 4; r++)
+	{
+		size_t len = skat_cardset_size(cs & rows[r]);
+		if (rows[r] == 0)
+			continue; // the trump suit
+		side += len, longest = std::max(longest, len);
+		if (len == 0)
+			voids++;
+		else if ((len == 1) && (skat_augen(cs & rows[r]) != 11))
+			singletons++;
+	}
+	x[1] = trumps / 11.0f;
+	x[8] = aces / 4.0f;
+	x[9] = tens_a / 4.0f;
+	x[10] = tens / 4.0f;
+	x[11] = voids / 4.0f;
+	x[12] = (side - aces - tens_a) / 10.0f;
+	x[13] = singletons / 4.0f;
+	x[14] = skat_augen(cs) / 120.0f;
+	x[18] = (trumps >= 6) ? 1.0f : 0.0f;
+	x[19] = (trumps >= 7) ? 1.0f : 0.0f;
+	x[20] = longest / 7.0f;
+	// the top trumps in a row (mit ...)
+	x[21] = ((cs & skat_card2set(0)) ? skat_spitzen(spiel, cs) : 0) / 11.0f;
+	x[22] = high / 6.0f;
+	x[23] = kings / 4.0f;
+	if (pos < 2)
+		x[15 + pos] = 1.0f;
+}
+
+// features of a Null game: a suit is safe, if its k-th lowest own card is
+// not higher than the (2k-1)-th lowest card of the suit
+static void skat_learn_null
+	(const size_t spiel, const skat_cardset_t cs, const size_t pos,
+	float *x)
+{
+	size_t safe = 0, voids = 0, danger = 0, max_danger = 0, one = 0, more = 0;
+	size_t single = 0, longest = 0, low[3] = { 0, 0, 0 }, high = 0;
+	for (size_t s = 0; s < 4; s++)
+	{
+		bool own[8] = { false, false, false, false, false, false, false, false };
+		size_t len = 0;
+		for (size_t c = 0; c < 32; c++)
+		{
+			if ((skat_cardrow(spiel, c) != s) || !(cs & skat_card2set(c)))
+				continue;
+			size_t v = 7 - skat_cardrank(spiel, c); // 0 = seven, 7 = ace
+			own[v] = true, len++;
+			if (v < 3)
+				low[v]++;
+			if (v >= 6)
+				high++;
+		}
+		if (len == 0)
+		{
+			voids++;
+			continue;
+		}
+		size_t k = 0, d = 0;
+		for (size_t v = 0; v < 8; v++)
+		{
+			if (!own[v])
+				continue;
+			if (v > (2 * k))
+				d++;
+			k++;
+		}
+		if (d == 0)
+			safe++;
+		else if (d == 1)
+			one++;
+		else
+			more++;
+		if ((len == 1) && !own[0])
+			single++;
+		danger += d, max_danger = std::max(max_danger, d);
+		longest = std::max(longest, len);
+	}
+	x[1] = safe / 4.0f;
+	x[2] = voids / 4.0f;
+	x[3] = danger / 10.0f;
+	x[4] = max_danger / 4.0f;
+	x[5] = low[0] / 4.0f;
+	x[6] = low[1] / 4.0f;
+	x[7] = low[2] / 4.0f;
+	x[8] = one / 4.0f;
+	x[9] = more / 4.0f;
+	x[12] = single / 4.0f;
+	x[13] = longest / 8.0f;
+	x[14] = high / 8.0f;
+	if (pos < 2)
+		x[10 + pos] = 1.0f;
+}
+
+void skat_learn_features
+	(
+		const size_t spiel, const size_t mode, const skat_cardset_t cs,
+		const size_t pos, float *x
+	)
+{
+	skat_cardset_t hand = cs, d = 0;
+	memset(x, 0, SKAT_LEARN_FEATURES * sizeof(float));
+	x[0] = 1.0f;
+	if (skat_cardset_size(cs) == 12)
+		d = skat_eval_druecken(spiel, cs), hand &= ~d;
+	if (skat_learn_kind(spiel) == SKAT_LEARN_NULL)
+		skat_learn_null(spiel, hand, pos, x);
+	else
+	{
+		skat_learn_trump(spiel, hand, pos, x);
+		if (mode == SKAT_LEARN_TAKEN)
+			x[17] = skat_augen(d) / 22.0f;
+	}
+}
+
+// dot product of two vectors of SKAT_LEARN_FEATURES floats
+float skat_learn_dot
+	(
+		const float *w, const float *x
+	)
+{
+#if defined(__AVX__)
+	__m256 acc = _mm256_setzero_ps();
+	for (size_t i = 0; i < SKAT_LEARN_FEATURES; i += 8)
+		acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(w + i),
+			_mm256_loadu_ps(x + i)));
+	__m128 s = _mm_add_ps(_mm256_castps256_ps128(acc),
+		_mm256_extractf128_ps(acc, 1));
+	s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+	s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+	return _mm_cvtss_f32(s);
+#elif defined(__SSE__)
+	__m128 acc = _mm_setzero_ps();
+	for (size_t i = 0; i < SKAT_LEARN_FEATURES; i += 4)
+		acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(w + i),
+			_mm_loadu_ps(x + i)));
+	acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+	acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+	return _mm_cvtss_f32(acc);
+#else
+	float s = 0.0f;
+	for (size_t i = 0; i < SKAT_LEARN_FEATURES; i++)
+		s += w[i] * x[i];
+	return s;
+#endif
+}
+
+// the weights of the distributed SecureSkat.model (as written by
+// SecureSkat_train), used if no model file can be loaded
+static const float skat_model_builtin[SKAT_LEARN_KINDS][SKAT_LEARN_MODES]
+	[SKAT_LEARN_FEATURES] =
+{
+	{
+		{ -2.74665f, 3.58718f, 0.910808f, 0.731097f, 0.455224f, 0.320221f,
+			0.530151f, 0.20841f, 3.37201f, -1.737f, 1.42271f, 2.8934f,
+			-7.34649f, 1.11818f, 0.806565f, 0.291454f, -0.0601349f, 0.0f,
+			0.0364161f, 0.0707235f, 0.319248f, 1.73838f, 0.525941f, 0.0211069f },
+		{ -5.16095f, 1.85403f, 1.70657f, 1.1107f, 0.827156f, 0.513353f,
+			0.726198f, 0.280776f, 4.80465f, 0.192744f, 0.915354f, 4.21199f,
+			-9.20086f, -0.319455f, 1.57342f, 0.544859f, -0.156659f, 0.0f,
+			0.751687f, 0.612354f, 1.81585f, 0.493572f, 0.860673f, -0.295718f },
+		{ -6.94654f, 1.47689f, 1.85019f, 1.36967f, 0.869657f, 0.507826f,
+			0.969119f, 0.455318f, 6.80703f, -0.491959f, 0.312839f, 4.72625f,
+			-11.0988f, 0.461244f, 1.59676f, 0.457763f, -0.067478f, 2.03198f,
+			1.07782f, 1.0737f, 1.20717f, 1.62926f, 1.00322f, 0.433914f }
+	},
+	{
+		{ -3.98097f, 0.380131f, 1.77661f, 0.888185f, 0.770955f, 0.744062f,
+			0.0f, 0.0f, 4.33123f, -0.336595f, 2.1617f, 1.84596f, -5.9968f,
+			0.715774f, 1.42729f, 0.66251f, -0.0886475f, 0.0f, 0.0f, 0.0f,
+			2.36078f, -0.785108f, 0.696923f, 0.465355f },
+		{ -4.9275f, 0.459064f, 2.20858f, 1.05268f, 0.915256f, 0.875325f,
+			0.0f, 0.0f, 4.81378f, 0.875488f, 1.6155f, 2.5624f, -7.70978f,
+			-0.201429f, 1.62353f, 0.774029f, -0.0985253f, 0.0f, 0.0f, 0.0f,
+			2.40817f, -0.71727f, 0.84141f, 0.249295f },
+		{ -6.79986f, 0.564039f, 2.72764f, 1.3341f, 1.14288f, 1.00183f, 0.0f,
+			0.0f, 6.35718f, 0.170998f, 0.473028f, 2.85003f, -10.0313f,
+			0.414638f, 1.30527f, 0.846197f, -0.13151f, 2.24781f, 0.0f, 0.0f,
+			3.39439f, -1.10105f, 1.03416f, 0.659123f }
+	},
+	{
+		{ -2.09468f, -0.427311f, 0.998267f, -2.35363f, -1.47636f, 2.59045f,
+			1.63454f, 0.951486f, -1.24214f, -1.42284f, 0.0902676f,
+			-0.222395f, 0.422224f, 0.140638f, -0.300825f, 0.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+		{ -1.75892f, 0.314248f, 1.69585f, -2.61995f, -1.92773f, 1.26135f,
+			1.39991f, -0.015328f, -1.30851f, -2.46184f, 0.17052f,
+			-0.0746544f, -0.32675f, 0.434291f, -1.98238f, 0.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f },
+		{ -2.06488f, 0.105419f, 1.8324f, -2.69848f, -3.4917f, 1.87682f,
+			1.79434f, 0.82532f, -2.11276f, -1.88952f, 0.0166225f, -0.264462f,
+			-0.382167f, 0.943743f, -0.820912f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 0.0f }
+	}
+};
+
+skat_model::skat_model
+	():
+		ready(false)
+{
+	memset(weights, 0, sizeof(weights));
+}
+
+void skat_model::defaults
+	()
+{
+	memcpy(weights, skat_model_builtin, sizeof(weights));
+	ready = true;
+}
+
+// text file: magic, numbers of kinds, modes and features, then the weights
+bool skat_model::load
+	(const std::string &file)
+{
+	std::ifstream ifs(file.c_str());
+	std::string magic;
+	size_t kinds = 0, modes = 0, features = 0;
+	ifs >> magic >> kinds >> modes >> features;
+	if (!ifs.good() || (magic != SKAT_LEARN_MAGIC) ||
+		(kinds != SKAT_LEARN_KINDS) || (modes != SKAT_LEARN_MODES) ||
+		(features != SKAT_LEARN_FEATURES))
+			return false;
+	for (size_t k = 0; k < SKAT_LEARN_KINDS; k++)
+		for (size_t m = 0; m < SKAT_LEARN_MODES; m++)
+			for (size_t f = 0; f < SKAT_LEARN_FEATURES; f++)
+				ifs >> weights[k][m][f];
+	if (ifs.fail())
+		return false;
+	ready = true;
+	return true;
+}
+
+bool skat_model::save
+	(const std::string &file) const
+{
+	std::ofstream ofs(file.c_str());
+	ofs << SKAT_LEARN_MAGIC << " " << SKAT_LEARN_KINDS << " " <<
+		SKAT_LEARN_MODES << " " << SKAT_LEARN_FEATURES << std::endl;
+	ofs.precision(6);
+	for (size_t k = 0; k < SKAT_LEARN_KINDS; k++)
+	{
+		for (size_t m = 0; m < SKAT_LEARN_MODES; m++)
+		{
+			for (size_t f = 0; f < SKAT_LEARN_FEATURES; f++)
+				ofs << ((f > 0) ? " " : "") << weights[k][m][f];
+			ofs << std::endl;
+		}
+	}
+	return ofs.good();
+}
+
+float *skat_model::w
+	(const size_t kind, const size_t mode)
+{
+	return weights[kind][mode];
+}
+
+void skat_model::predict
+	(const size_t kind, const size_t mode, const float *x,
+	const size_t n, float *p) const
+{
+	const float *wv = weights[kind][mode];
+	for (size_t i = 0; i < n; i++)
+		p[i] = 1.0f / (1.0f + expf(-skat_learn_dot(wv,
+			x + (i * SKAT_LEARN_FEATURES))));
+}
+
+double skat_model::win
+	(const size_t spiel, const size_t mode, const skat_cardset_t cs,
+	const size_t pos) const
+{
+	float x[SKAT_LEARN_FEATURES] __attribute__((aligned(32))), p = 0.0f;
+	skat_learn_features(spiel, mode, cs, pos, x);
+	predict(skat_learn_kind(spiel), mode, x, 1, &p);
+	return p;
+}
+
+// the candidate games as skat_eval::evaluate, but estimated by the model
+size_t skat_model::evaluate
+	(const skat_cardset_t cards, const size_t pos,
+	const size_t min_wert, std::vector<skat_bid> &result) const
+{
+	size_t n = skat_cardset_size(cards);
+	result.clear();
+	for (size_t i = 0; i < 6; i++)
+	{
+		size_t spiel = skat_learn_spiele[i], gwert = skat_spiel2gwert(spiel);
+		for (size_t h = 0; h < ((n == 12) ? 1 : 2); h++)
+		{
+			skat_bid b;
+			size_t mode = (n == 12) ? SKAT_LEARN_TAKEN :
+				((h == 1) ? SKAT_LEARN_HAND : SKAT_LEARN_SKAT);
+			b.spiel = spiel, b.hand = (h == 1), b.samples = 1;
+			b.wert = skat_eval_wert(spiel, b.hand, cards);
+			// trained on solved deals, calibrated by self-play outcomes
+			b.win = skat_eval_calibrate(win(spiel, mode, cards, pos),
+				SKAT_LEARN_CALIBRATE_A, SKAT_LEARN_CALIBRATE_B);
+			long wert = b.wert;
+			double q = b.win;
+			if (wert < (long)min_wert)
+			{
+				// overbid: lost with the next multiple of the Grundwert
+				wert = ((min_wert + gwert - 1) / gwert) * gwert;
+				q = 0.0;
+			}
+			b.score = skat_eval_score(q, wert);
+			result.push_back(b);
+		}
+	}
+	return result.size();
+}
+
+skat_model::~skat_model
+	()
+{
+}
+
+static skat_model skat_model_instance;
+static pthread_once_t skat_model_once = PTHREAD_ONCE_INIT;
+
+static void skat_model_init
+	()
+{
+	const char *env = getenv("SECURESKAT_MODEL");
+	if (!skat_model_instance.load((env != NULL) ? env : SKAT_MODEL))
+		skat_model_instance.defaults();
+}
+
+skat_model &skat_model_default
+	()
+{
+	pthread_once(&skat_model_once, skat_model_init);
+	return skat_model_instance;
+}
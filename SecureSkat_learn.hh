@@ -0,0 +1,121 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_learn_HH
+	#define INCLUDED_SecureSkat_learn_HH
+
+	#include "SecureSkat_defs.hh"
+	#include "SecureSkat_rule.hh"
+	#include "SecureSkat_eval.hh"
+
+	#if defined(__AVX__) || defined(__SSE__)
+		#include <immintrin.h>
+	#endif
+
+	// kinds of games with their own weights (suit games are symmetric)
+	#define SKAT_LEARN_SUIT		0
+	#define SKAT_LEARN_GRAND	1
+	#define SKAT_LEARN_NULL		2
+	#define SKAT_LEARN_KINDS	3
+
+	// modes: 10 cards and the skat will be taken, 10 cards for a hand game,
+	// 12 cards (the skat was taken and two cards are put away)
+	#define SKAT_LEARN_SKAT		0
+	#define SKAT_LEARN_HAND		1
+	#define SKAT_LEARN_TAKEN	2
+	#define SKAT_LEARN_MODES	3
+
+	// number of features (a multiple of 8 for the vector kernel)
+	#define SKAT_LEARN_FEATURES	24
+
+	#define SKAT_LEARN_MAGIC	"SSKATLM1"
+
+	// candidates below this winning probability are not simulated by skat_eval
+	#define SKAT_LEARN_HOPELESS	0.02
+
+	// calibration of the predictions for bidding (skat_eval_calibrate)
+	#define SKAT_LEARN_CALIBRATE_A	0.91
+	#define SKAT_LEARN_CALIBRATE_B	0.73
+
+	#ifndef SKAT_MODEL
+		#define SKAT_MODEL		"SecureSkat.model"
+	#endif
+
+	size_t skat_learn_kind
+		(
+			const size_t spiel
+		);
+
+	// features of the declarer's cards cs for the game spiel in the given
+	// mode at position pos (0 = Vorhand); with 12 cards the cards put away
+	// are chosen by skat_eval_druecken
+	void skat_learn_features
+		(
+			const size_t spiel, const size_t mode, const skat_cardset_t cs,
+			const size_t pos, float *x
+		);
+
+	float skat_learn_dot
+		(
+			const float *w, const float *x
+		);
+
+	// Learned evaluation of the declarer's cards: logistic regression of the
+	// double-dummy result (as the simulation of skat_eval) on features of
+	// the cards. The weights are trained by SecureSkat_train from solved
+	// random deals and stored as text.
+	class skat_model
+	{
+		private:
+			float weights[SKAT_LEARN_KINDS][SKAT_LEARN_MODES]
+				[SKAT_LEARN_FEATURES] __attribute__((aligned(32)));
+
+		public:
+			bool ready;
+
+			skat_model
+				();
+			bool load
+				(const std::string &file);
+			bool save
+				(const std::string &file) const;
+			// the weights of the distributed model (compiled in)
+			void defaults
+				();
+			float *w
+				(const size_t kind, const size_t mode);
+			// winning probabilities of n feature vectors (n * FEATURES floats)
+			void predict
+				(const size_t kind, const size_t mode, const float *x,
+				const size_t n, float *p) const;
+			double win
+				(const size_t spiel, const size_t mode, const skat_cardset_t cs,
+				const size_t pos) const;
+			size_t evaluate
+				(const skat_cardset_t cards, const size_t pos,
+				const size_t min_wert, std::vector<skat_bid> &result) const;
+			~skat_model
+				();
+	};
+
+	// the default model (environment SECURESKAT_MODEL, installed or compiled in)
+	skat_model &skat_model_default
+		();
+#endif
@@ -0,0 +1,294 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_mask.hh"
+
+// overwrite the limbs before they are released
+static void skat_mask_wipe
+	(mpz_t x)
+{
+	memset(x->_mp_d, 0, x->_mp_alloc * sizeof(mp_limb_t));
+	mpz_clear(x);
+}
+
+skat_fpowm::skat_fpowm
+	(mpz_srcptr base, mpz_srcptr modulus, const size_t bits):
+		limbs(mpz_size(modulus)),
+		windows((bits + SKAT_FPOWM_WINDOW - 1) / SKAT_FPOWM_WINDOW)
+{
+	const size_t digits = 1 << SKAT_FPOWM_WINDOW;
+	mpz_t b, x;
+	mpz_init_set(p, modulus);
+	mpz_init(b), mpz_init(x);
+	mpz_mod(b, base, p);
+	table.resize(windows * digits * limbs, 0);
+	for (size_t i = 0; i < windows; i++)
+	{
+		// b = base^(2^(w * i)) and x = b^j
+		mpz_set_ui(x, 1);
+		for (size_t j = 0; j < digits; j++)
+		{
+			mpz_export(&table[((i * digits) + j) * limbs], NULL, -1,
+				sizeof(mp_limb_t), 0, 0, x);
+			mpz_mul(x, x, b);
+			mpz_mod(x, x, p);
+		}
+		for (size_t k = 0; k < SKAT_FPOWM_WINDOW; k++)
+		{
+			mpz_mul(b, b, b);
+			mpz_mod(b, b, p);
+		}
+	}
+	mpz_clear(b), mpz_clear(x);
+}
+
+size_t skat_fpowm::memory
+	(mpz_srcptr modulus, const size_t bits)
+{
+	size_t windows = (bits + SKAT_FPOWM_WINDOW - 1) / SKAT_FPOWM_WINDOW;
+	return windows * (1 << SKAT_FPOWM_WINDOW) * mpz_size(modulus) *
+		sizeof(mp_limb_t);
+}
+
+void skat_fpowm::powm
+	(mpz_ptr res, mpz_srcptr exp) const
+{
+	const size_t digits = 1 << SKAT_FPOWM_WINDOW;
+	assert(mpz_sgn(exp) >= 0);
+	assert(mpz_sizeinbase(exp, 2) <= (windows * SKAT_FPOWM_WINDOW));
+	std::vector<mp_limb_t> entry(limbs);
+	mpz_t x;
+	mpz_init2(x, limbs * GMP_NUMB_BITS);
+	mpz_set_ui(res, 1);
+	for (size_t i = 0; i < windows; i++)
+	{
+		size_t d = 0;
+		for (size_t k = 0; k < SKAT_FPOWM_WINDOW; k++)
+			d |= mpz_tstbit(exp, (i * SKAT_FPOWM_WINDOW) + k) << k;
+		// select the entry d without a branch or an index depending on d
+		const mp_limb_t *t = &table[i * digits * limbs];
+		std::fill(entry.begin(), entry.end(), 0);
+		for (size_t j = 0; j < digits; j++, t += limbs)
+		{
+			mp_limb_t mask = (mp_limb_t)0 - (mp_limb_t)(j == d);
+			for (size_t l = 0; l < limbs; l++)
+				entry[l] |= t[l] & mask;
+		}
+		mpz_import(x, limbs, -1, sizeof(mp_limb_t), 0, 0, &entry[0]);
+		mpz_mul(res, res, x);
+		mpz_mod(res, res, p);
+	}
+	std::fill(entry.begin(), entry.end(), 0);
+	skat_mask_wipe(x);
+}
+
+skat_fpowm::~skat_fpowm
+	()
+{
+	std::fill(table.begin(), table.end(), 0);
+	mpz_clear(p);
+}
+
+void skat_mask_config
+	(size_t &size, size_t &num_threads, size_t &memory)
+{
+	size = SKAT_MASK_SIZE, num_threads = SKAT_MASK_THREADS;
+	memory = SKAT_MASK_MEMORY;
+	if (getenv("SECURESKAT_MASKPOOL") != NULL)
+		size = strtoul(getenv("SECURESKAT_MASKPOOL"), NULL, 10);
+	if (getenv("SECURESKAT_MASKPOOL_THREADS") != NULL)
+		num_threads = strtoul(getenv("SECURESKAT_MASKPOOL_THREADS"), NULL, 10);
+	if (getenv("SECURESKAT_MASKPOOL_MEMORY") != NULL)
+		memory = strtoul(getenv("SECURESKAT_MASKPOOL_MEMORY"), NULL, 10);
+}
+
+skat_mask_pool::skat_mask_pool
+	(const BarnettSmartVTMF_dlog *vtmf, const size_t size,
+	const size_t num_threads, const size_t memory):
+		fg(NULL), fh(NULL), capacity(0), filling(0), quit(false),
+		paused(false), hits(0), dry(0)
+{
+	mpz_init_set(p, vtmf->p), mpz_init_set(q, vtmf->q);
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&cond, NULL);
+	pthread_cond_init(&idle, NULL);
+	// the tables of g and h are part of the memory
+	size_t bits = mpz_sizeinbase(q, 2);
+	size_t bytes = sizeof(tuple) +
+		((mpz_size(q) + (2 * mpz_size(p))) * sizeof(mp_limb_t));
+	size_t tables = 2 * skat_fpowm::memory(p, bits);
+	if ((memory * 1024) > tables)
+		capacity = std::min(size, ((memory * 1024) - tables) / bytes);
+	if (capacity == 0)
+		return;
+	fg = new skat_fpowm(vtmf->g, p, bits);
+	fh = new skat_fpowm(vtmf->h, p, bits);
+	threads.resize((num_threads > 0) ? num_threads : 1);
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		if (pthread_create(&threads[i], NULL, run, this))
+		{
+			perror("skat_mask_pool (pthread_create)");
+			threads.resize(i);
+			break;
+		}
+	}
+}
+
+// r is uniform in Z_q
+void skat_mask_pool::compute
+	(tuple *t)
+{
+	mpz_init(t->r), mpz_init(t->gr), mpz_init(t->hr);
+	tmcg_mpz_srandomm(t->r, q);
+	fg->powm(t->gr, t->r);
+	fh->powm(t->hr, t->r);
+}
+
+skat_mask_pool::tuple *skat_mask_pool::take
+	()
+{
+	tuple *t = NULL;
+	pthread_mutex_lock(&mutex);
+	if (!tuples.empty())
+	{
+		t = tuples.front();
+		tuples.pop_front();
+		hits++;
+		pthread_cond_signal(&cond);
+	}
+	else
+		dry++;
+	pthread_mutex_unlock(&mutex);
+	if (t == NULL)
+	{
+		t = new tuple;
+		compute(t);
+	}
+	return t;
+}
+
+void skat_mask_pool::release
+	(tuple *t)
+{
+	skat_mask_wipe(t->r), skat_mask_wipe(t->gr), skat_mask_wipe(t->hr);
+	delete t;
+}
+
+void *skat_mask_pool::run
+	(void *arg)
+{
+	skat_mask_pool *pool = (skat_mask_pool*)arg;
+#ifdef SCHED_IDLE
+	// refill only while the processor is idle otherwise
+	struct sched_param param;
+	memset(&param, 0, sizeof(param));
+	pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+	pthread_mutex_lock(&pool->mutex);
+	while (!pool->quit)
+	{
+		if (pool->paused ||
+			((pool->tuples.size() + pool->filling) >= pool->capacity))
+		{
+			pthread_cond_wait(&pool->cond, &pool->mutex);
+			continue;
+		}
+		pool->filling++;
+		pthread_mutex_unlock(&pool->mutex);
+		tuple *t = new tuple;
+		pool->compute(t);
+		pthread_mutex_lock(&pool->mutex);
+		pool->filling--;
+		pool->tuples.push_back(t);
+		if (pool->filling == 0)
+			pthread_cond_broadcast(&pool->idle);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	return NULL;
+}
+
+size_t skat_mask_pool::size
+	() const
+{
+	return capacity;
+}
+
+void skat_mask_pool::mix
+	(const TMCG_Stack<VTMF_Card> &s, TMCG_Stack<VTMF_Card> &s2,
+	TMCG_StackSecret<VTMF_CardSecret> &ss)
+{
+	assert((capacity > 0) && (s.size() == ss.size()));
+	// c'_1 = c_1 * g^r and c'_2 = c_2 * h^r (mod p) of the card at the
+	// position ss[i].first, as VerifiableRemaskingProtocol_Remask
+	s2.clear();
+	for (size_t i = 0; i < ss.size(); i++)
+	{
+		VTMF_Card c;
+		const VTMF_Card &cs = s[ss.stack[i].first];
+		tuple *t = take();
+		mpz_set(ss.stack[i].second.r, t->r);
+		mpz_mul(c.c1, cs.c1, t->gr);
+		mpz_mod(c.c1, c.c1, p);
+		mpz_mul(c.c2, cs.c2, t->hr);
+		mpz_mod(c.c2, c.c2, p);
+		release(t);
+		s2.push(c);
+	}
+}
+
+void skat_mask_pool::pause
+	()
+{
+	pthread_mutex_lock(&mutex);
+	paused = true;
+	while (filling > 0)
+		pthread_cond_wait(&idle, &mutex);
+	pthread_mutex_unlock(&mutex);
+}
+
+void skat_mask_pool::resume
+	()
+{
+	pthread_mutex_lock(&mutex);
+	paused = false;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+skat_mask_pool::~skat_mask_pool
+	()
+{
+	pthread_mutex_lock(&mutex);
+	quit = true;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&mutex);
+	for (size_t i = 0; i < threads.size(); i++)
+		pthread_join(threads[i], NULL);
+	for (size_t i = 0; i < tuples.size(); i++)
+		release(tuples[i]);
+	tuples.clear();
+	pthread_cond_destroy(&idle);
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&mutex);
+	delete fg;
+	delete fh;
+	mpz_clear(p), mpz_clear(q);
+}
@@ -0,0 +1,124 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_mask_HH
+	#define INCLUDED_SecureSkat_mask_HH
+
+	#include "SecureSkat_defs.hh"
+
+	// defaults: masking values of three decks, one thread, 1024 KiB
+	#define SKAT_MASK_SIZE		96
+	#define SKAT_MASK_THREADS	1
+	#define SKAT_MASK_MEMORY	1024
+
+	#define SKAT_FPOWM_WINDOW	4
+
+	// Fixed-base exponentiation: the table contains base^(j * 2^(w * i))
+	// for each window i of the exponent and each digit j (w bits), thus an
+	// exponentiation needs one multiplication per window and no squaring.
+	// All entries of a window are read and the wanted one is selected by a
+	// mask, thus the table access does not depend on the secret exponent.
+	// The GMP arithmetic (mpz_tstbit, mpz_mul, mpz_mod) is not constant time.
+	class skat_fpowm
+	{
+		private:
+			mpz_t p;
+			size_t limbs, windows;
+			std::vector<mp_limb_t> table;
+
+		public:
+			// exponents of at most bits bits
+			skat_fpowm
+				(mpz_srcptr base, mpz_srcptr modulus, const size_t bits);
+			// size of the table in bytes
+			static size_t memory
+				(mpz_srcptr modulus, const size_t bits);
+			void powm
+				(mpz_ptr res, mpz_srcptr exp) const;
+			~skat_fpowm
+				();
+	};
+
+	// Pool of masking values (r, g^r, h^r) for the VTMF key of a table. The
+	// values are computed in advance by threads of the lowest priority, thus
+	// shuffling the deck needs two multiplications per card instead of the
+	// exponentiations of TMCG_MixStack. If the pool has run dry, the values
+	// are computed on demand. Values are overwritten, when they are used and
+	// when the pool is destroyed. The values are computed by fixed-base
+	// tables of g and h, which are built by the constructor, i.e. the key
+	// (KeyGenerationProtocol_Finalize) must be complete.
+	class skat_mask_pool
+	{
+		private:
+			struct tuple
+			{
+				mpz_t r, gr, hr;
+			};
+
+			mpz_t p, q;
+			skat_fpowm *fg, *fh;
+			std::deque<tuple*> tuples;
+			std::vector<pthread_t> threads;
+			pthread_mutex_t mutex;
+			pthread_cond_t cond, idle;
+			size_t capacity, filling;
+			bool quit, paused;
+
+			void compute
+				(tuple *t);
+			tuple *take
+				();
+			static void release
+				(tuple *t);
+			static void *run
+				(void *arg);
+
+		public:
+			unsigned long hits, dry;
+
+			// size, number of threads and memory (in KiB, including the
+			// tables) of the pool; the capacity is the smaller one of size
+			// and memory (0 means no pool and no tables)
+			skat_mask_pool
+				(const BarnettSmartVTMF_dlog *vtmf, const size_t size,
+				const size_t num_threads, const size_t memory);
+			size_t size
+				() const;
+			// shuffles s by the permutation of ss as TMCG_MixStack does;
+			// the masking values of ss are replaced by those of the pool
+			// (only if size() > 0)
+			void mix
+				(const TMCG_Stack<VTMF_Card> &s, TMCG_Stack<VTMF_Card> &s2,
+				TMCG_StackSecret<VTMF_CardSecret> &ss);
+			// parks the threads before a fork(), since a thread could hold
+			// a lock of libgcrypt (random pool) that a child never gets
+			void pause
+				();
+			void resume
+				();
+			~skat_mask_pool
+				();
+	};
+
+	// configuration by environment SECURESKAT_MASKPOOL (size, 0 = no pool),
+	// SECURESKAT_MASKPOOL_THREADS and SECURESKAT_MASKPOOL_MEMORY (in KiB)
+	void skat_mask_config
+		(size_t &size, size_t &num_threads, size_t &memory);
+#endif
@@ -0,0 +1,371 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_null.hh"
+
+static inline size_t skat_null_high
+	(
+		const uint8_t row
+	)
+{
+	return 31 - __builtin_clz(row);
+}
+
+static inline size_t skat_null_low
+	(
+		const uint8_t row
+	)
+{
+	return __builtin_ctz(row);
+}
+
+size_t skat_null_card
+	(
+		const size_t r, const size_t bit
+	)
+{
+	// position of the card in the suit (A, 10, K, O, 9, 8, 7) for each bit
+	static const size_t pos[8] = { 6, 5, 4, 1, 99, 3, 2, 0 };
+	if ((r > 3) || (bit > 7))
+		return 99;
+	return (bit == 4) ? r : (4 + (7 * r) + pos[bit]);
+}
+
+uint8_t skat_null_row
+	(
+		const skat_cardset_t cs, const size_t r
+	)
+{
+	uint8_t row = (cs & skat_card2set(r)) ? (1 << 4) : 0;
+	skat_cardset_t s = (cs >> (4 + (7 * r))) & 0x7F;
+	while (s)
+	{
+		size_t k = __builtin_ctz(s);
+		row |= (1 << skat_null_bit(4 + k));
+		s &= (s - 1);
+	}
+	return row;
+}
+
+uint8_t skat_null_caught
+	(
+		const uint8_t own, const uint8_t opp
+	)
+{
+	uint8_t caught = 0;
+	size_t k = 0;
+	for (size_t b = 0; b < 8; b++)
+	{
+		if ((own & (1 << b)) == 0)
+			continue;
+		k++;
+		if ((size_t)__builtin_popcount(opp & ((1 << b) - 1)) >= k)
+			caught |= (1 << b);
+	}
+	return caught;
+}
+
+size_t skat_null_danger
+	(
+		const skat_cardset_t own, const skat_cardset_t opp
+	)
+{
+	size_t n = 0;
+	for (size_t r = 0; r < 4; r++)
+	{
+		n += __builtin_popcount(skat_null_caught(skat_null_row(own, r),
+			skat_null_row(opp, r)));
+	}
+	return n;
+}
+
+skat_cardset_t skat_null_leads
+	(
+		const skat_cardset_t own, const skat_cardset_t opp, const size_t hidden
+	)
+{
+	uint8_t o[4], g[4];
+	size_t danger = 0;
+	for (size_t r = 0; r < 4; r++)
+	{
+		o[r] = skat_null_row(own, r), g[r] = skat_null_row(opp, r);
+		danger += __builtin_popcount(skat_null_caught(o[r], g[r]));
+	}
+	if (danger > 0)
+		return 0;
+	skat_cardset_t leads = 0;
+	for (size_t r = 0; r < 4; r++)
+	{
+		// below all cards of the opponents, one of them must follow suit
+		if ((o[r] == 0) || ((size_t)__builtin_popcount(g[r]) <= hidden))
+			continue;
+		uint8_t cand = o[r] & ((1 << skat_null_low(g[r])) - 1);
+		// worst case: the opponents put their highest card of the row
+		uint8_t g2 = g[r] & ~(1 << skat_null_high(g[r]));
+		while (cand)
+		{
+			size_t b = skat_null_low(cand);
+			if (skat_null_caught(o[r] & ~(1 << b), g2) == 0)
+				leads |= skat_card2set(skat_null_card(r, b));
+			cand &= (cand - 1);
+		}
+	}
+	return leads;
+}
+
+bool skat_null_sure
+	(
+		const skat_cardset_t own, const skat_cardset_t opp, const bool lead,
+		const size_t hidden
+	)
+{
+	if (skat_null_danger(own, opp) > 0)
+		return false;
+	return (!lead || skat_null_leads(own, opp, hidden));
+}
+
+skat_cardset_t skat_null_druecken
+	(
+		const skat_cardset_t cs, const bool lead
+	)
+{
+	std::vector<size_t> cv;
+	skat_cardset2vector(cs, cv);
+	skat_cardset_t best = 0;
+	size_t best_score = 0;
+	for (size_t i = 0; i < cv.size(); i++)
+	{
+		for (size_t j = i + 1; j < cv.size(); j++)
+		{
+			skat_cardset_t d = skat_card2set(cv[i]) | skat_card2set(cv[j]);
+			skat_cardset_t h = cs & ~d;
+			// cards that can be caught, then the highest cards put away
+			size_t danger = skat_null_danger(h, ~cs);
+			if (lead && (danger == 0) && (skat_null_leads(h, ~cs, 0) == 0))
+				danger = 1;
+			size_t score = (danger * 16) + 14 -
+				(skat_null_bit(cv[i]) + skat_null_bit(cv[j]));
+			if ((best == 0) || (score < best_score))
+				best = d, best_score = score;
+		}
+	}
+	return best;
+}
+
+// the highest card (in the Null order) of cs, preferably one that can be
+// caught by the opponents
+static size_t skat_null_discard
+	(
+		const skat_cardset_t cs, const skat_cardset_t opp
+	)
+{
+	size_t card = 99, key = 0;
+	for (size_t r = 0; r < 4; r++)
+	{
+		uint8_t o = skat_null_row(cs, r);
+		if (o == 0)
+			continue;
+		uint8_t c = skat_null_caught(o, skat_null_row(opp, r));
+		size_t k = (c) ? (skat_null_high(c) + 9) : (skat_null_high(o) + 1);
+		if (k > key)
+		{
+			card = skat_null_card(r, (c) ? skat_null_high(c) : skat_null_high(o));
+			key = k;
+		}
+	}
+	return card;
+}
+
+static bool skat_null_declarer
+	(
+		const skat_infoset &is, const skat_cardset_t legal, const size_t r,
+		const size_t w, size_t &card
+	)
+{
+	skat_cardset_t own = is.hand[is.self], opp = is.unknown;
+	size_t hidden = is.count[3];
+	if (is.trick_len == 0)
+	{
+		// safe line: a lead below the opponents and all rows stay safe
+		skat_cardset_t leads = skat_null_leads(own, opp, hidden) & legal;
+		if (leads)
+		{
+			card = skat_null_discard(leads, 0);
+			return true;
+		}
+		// otherwise the lead that leaves the fewest cards to be caught
+		size_t best_score = 0;
+		for (size_t c = 0; c < 32; c++)
+		{
+			if ((legal & skat_card2set(c)) == 0)
+				continue;
+			uint8_t g = skat_null_row(opp, skat_null_rowof(c));
+			bool takes = (g == 0) || ((size_t)__builtin_popcount(g) <= hidden) ||
+				(skat_null_bit(c) > skat_null_low(g));
+			size_t score = (takes) ? 100 : 0;
+			score += (skat_null_danger(own & ~skat_card2set(c), opp) * 8) +
+				(7 - skat_null_bit(c));
+			if ((card == 99) || (score < best_score))
+				card = c, best_score = score;
+		}
+		return false;
+	}
+	uint8_t o = skat_null_row(legal, r);
+	if (o)
+	{
+		// the highest card below the trick (ducking keeps the rows safe)
+		uint8_t below = o & ((1 << w) - 1);
+		if (below)
+		{
+			card = skat_null_card(r, skat_null_high(below));
+			return (skat_null_danger(own & ~skat_card2set(card), opp) == 0);
+		}
+		// forced to go above, maybe an opponent is forced, too
+		card = skat_null_card(r, skat_null_low(o));
+		return false;
+	}
+	card = skat_null_discard(legal, opp);
+	return (skat_null_danger(own & ~skat_card2set(card), opp) == 0);
+}
+
+static bool skat_null_opponent
+	(
+		const skat_infoset &is, const skat_cardset_t legal, const size_t r,
+		const size_t w, const size_t jw, size_t &card
+	)
+{
+	skat_cardset_t dh = is.hand[is.declarer];	// known, if ouvert
+	size_t jd = (is.declarer + 3 - is.lead) % 3;
+	if (is.trick_len > 0)
+	{
+		uint8_t o = skat_null_row(legal, r);
+		if ((jd < is.trick_len) && (jw == jd))
+		{
+			// the declarer takes the trick: do not overtake him
+			if (o)
+			{
+				uint8_t below = o & ((1 << w) - 1);
+				if (below)
+				{
+					card = skat_null_card(r, skat_null_high(below));
+					return true;
+				}
+				card = skat_null_card(r, skat_null_high(o));
+				return false;
+			}
+			card = skat_null_discard(legal, 0);
+			return true;
+		}
+		if (jd < is.trick_len)
+		{
+			// the declarer has ducked already
+			card = skat_null_discard(legal, 0);
+			return false;
+		}
+		if (o)
+		{
+			// the declarer follows: keep the trick as low as possible, but
+			// keep the low cards, if it is below the highest card anyway
+			uint8_t below = o & ((1 << w) - 1);
+			size_t b = (below) ? skat_null_high(below) : skat_null_low(o);
+			card = skat_null_card(r, b);
+			// the declarer (ouvert) has cards of the row, but none below
+			uint8_t d = skat_null_row(dh, r);
+			size_t bar = std::max(w, b);
+			return (d != 0) && ((d & ((1 << bar) - 1)) == 0);
+		}
+		card = skat_null_discard(legal, 0);
+		return false;
+	}
+	// lead: a card below all cards of the declarer in a row, if possible,
+	// otherwise the lowest card of a row where he may have cards
+	skat_cardset_t dp = (dh) ? dh : is.possible[is.declarer];
+	size_t low_card = 99, low_bit = 8;
+	for (size_t r2 = 0; r2 < 4; r2++)
+	{
+		uint8_t o = skat_null_row(legal, r2), d = skat_null_row(dp, r2);
+		if ((o == 0) || (d == 0))
+			continue;
+		uint8_t cand = o & ((1 << skat_null_low(d)) - 1);
+		if (cand)
+		{
+			card = skat_null_card(r2, skat_null_high(cand));
+			return (dh != 0) && (((is.self + 1) % 3) == is.declarer);
+		}
+		if (skat_null_low(o) < low_bit)
+		{
+			low_bit = skat_null_low(o);
+			low_card = skat_null_card(r2, low_bit);
+		}
+	}
+	if (low_card == 99)
+	{
+		for (size_t r2 = 0; r2 < 4; r2++)
+		{
+			uint8_t o = skat_null_row(legal, r2);
+			if (o && (skat_null_low(o) < low_bit))
+			{
+				low_bit = skat_null_low(o);
+				low_card = skat_null_card(r2, low_bit);
+			}
+		}
+	}
+	card = low_card;
+	return false;
+}
+
+bool skat_null_play
+	(
+		const skat_infoset &is, size_t &card
+	)
+{
+	skat_cardset_t own = is.hand[is.self];
+	size_t t = (is.trick_len > 0) ? is.trick[0] : 99;
+	skat_cardset_t legal = skat_legal(t, is.spiel, own);
+	card = 99;
+	if (legal == 0)
+		return false;
+	if (skat_cardset_size(legal) == 1)
+	{
+		card = __builtin_ctz(legal);
+		return true;
+	}
+	// row of the trick, highest card in the trick and its place
+	size_t r = 4, w = 0, jw = 0;
+	if (is.trick_len > 0)
+	{
+		r = skat_null_rowof(is.trick[0]), w = skat_null_bit(is.trick[0]);
+		for (size_t j = 1; j < is.trick_len; j++)
+		{
+			size_t b = skat_null_bit(is.trick[j]);
+			if ((skat_null_rowof(is.trick[j]) == r) && (b > w))
+				w = b, jw = j;
+		}
+	}
+	bool sure = (is.self == is.declarer) ?
+		skat_null_declarer(is, legal, r, w, card) :
+		skat_null_opponent(is, legal, r, w, jw, card);
+	if ((card > 31) || ((legal & skat_card2set(card)) == 0))
+	{
+		card = __builtin_ctz(legal);
+		return false;
+	}
+	return sure;
+}
@@ -0,0 +1,101 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_null_HH
+	#define INCLUDED_SecureSkat_null_HH
+
+	#include "SecureSkat_defs.hh"
+	#include "SecureSkat_rule.hh"
+	#include "SecureSkat_pimc.hh"
+
+	// Null games are analyzed row by row: the cards of a suit are 8 bits
+	// (bit 0 = 7, 1 = 8, 2 = 9, 3 = 10, 4 = U, 5 = O, 6 = K, 7 = A). A row of
+	// the declarer is safe, if he can duck every lead of the opponents, even
+	// if one of them holds all their cards of the row: for the i-th lowest
+	// card of the declarer there are less than i lower cards of them.
+	static inline size_t skat_null_bit
+		(
+			const size_t card
+		)
+	{
+		static const size_t bit[7] = { 7, 3, 6, 5, 2, 1, 0 };
+		return (card < 4) ? 4 : bit[(card - 4) % 7];
+	}
+
+	static inline size_t skat_null_rowof
+		(
+			const size_t card
+		)
+	{
+		return (card < 4) ? card : ((card - 4) / 7);
+	}
+
+	size_t skat_null_card
+		(
+			const size_t r, const size_t bit
+		);
+
+	uint8_t skat_null_row
+		(
+			const skat_cardset_t cs, const size_t r
+		);
+
+	// own cards of a row that can be caught by the opponents (as row bits)
+	uint8_t skat_null_caught
+		(
+			const uint8_t own, const uint8_t opp
+		);
+
+	// number of cards of the declarer that can be caught (0 = all rows safe)
+	size_t skat_null_danger
+		(
+			const skat_cardset_t own, const skat_cardset_t opp
+		);
+
+	// cards that the declarer can lead without taking the trick such that
+	// all rows stay safe; hidden of the opponents' cards may lie in the skat
+	skat_cardset_t skat_null_leads
+		(
+			const skat_cardset_t own, const skat_cardset_t opp,
+			const size_t hidden
+		);
+
+	// the declarer wins for sure (also ouvert), if he leads the first trick
+	// (lead) or not
+	bool skat_null_sure
+		(
+			const skat_cardset_t own, const skat_cardset_t opp, const bool lead,
+			const size_t hidden
+		);
+
+	// the two cards to put away from 12 cards (all 66 possibilities)
+	skat_cardset_t skat_null_druecken
+		(
+			const skat_cardset_t cs, const bool lead
+		);
+
+	// card play in a Null game; returns true, if the card is right for sure
+	// (safe line of the declarer, the declarer takes the trick or is forced
+	// to take it) and false, if the card is only a heuristic choice
+	bool skat_null_play
+		(
+			const skat_infoset &is, size_t &card
+		);
+#endif
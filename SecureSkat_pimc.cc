@@ -0,0 +1,307 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_pimc.hh"
+
+// xorshift64* generator (each worker thread has its own state)
+unsigned long long skat_random
+	(unsigned long long &state)
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 2685821657736338717ULL;
+}
+
+static void skat_infoset_position
+	(
+		const skat_infoset &is, const skat_cardset_t assigned[4],
+		skat_position &p
+	)
+{
+	skat_position_init(p, is.spiel, is.declarer, is.lead);
+	for (size_t i = 0; i < 3; i++)
+		p.hand[i] = is.hand[i] | assigned[i], p.trick[i] = is.trick[i];
+	p.trick_len = is.trick_len;
+	p.augen = is.augen + skat_augen(assigned[3]);
+}
+
+// distributes the unknown cards randomly such that each place gets the
+// right number of cards and each card goes to a place that can hold it
+bool skat_infoset_sample
+	(
+		const skat_infoset &is, skat_position &p, unsigned long long &state
+	)
+{
+	std::vector<size_t> uc;
+	skat_cardset2vector(is.unknown, uc);
+	for (size_t tries = 0; tries < 100; tries++)
+	{
+		size_t cap[4];
+		skat_cardset_t assigned[4] = { 0, 0, 0, 0 };
+		for (size_t d = 0; d < 4; d++)
+			cap[d] = is.count[d];
+		for (size_t i = uc.size(); i > 1; i--)
+			std::swap(uc[i - 1], uc[skat_random(state) % i]);
+		bool ok = true;
+		// the most restricted cards first
+		for (size_t e = 1; ok && (e <= 4); e++)
+		{
+			for (size_t i = 0; ok && (i < uc.size()); i++)
+			{
+				skat_cardset_t c = skat_card2set(uc[i]);
+				size_t n = 0, total = 0;
+				for (size_t d = 0; d < 4; d++)
+				{
+					if (is.possible[d] & c)
+					{
+						n++;
+						total += cap[d];
+					}
+				}
+				if (n != e)
+					continue;
+				if (total == 0)
+				{
+					ok = false;
+					break;
+				}
+				size_t r = skat_random(state) % total;
+				for (size_t d = 0; d < 4; d++)
+				{
+					if (!(is.possible[d] & c))
+						continue;
+					if (r < cap[d])
+					{
+						cap[d]--, assigned[d] |= c;
+						break;
+					}
+					r -= cap[d];
+				}
+			}
+		}
+		if (!ok)
+			continue;
+		skat_infoset_position(is, assigned, p);
+		return true;
+	}
+	return false;
+}
+
+static bool skat_infoset_enumerate
+	(
+		const skat_infoset &is, const std::vector<size_t> &uc, const size_t i,
+		size_t cap[4], skat_cardset_t assigned[4],
+		std::vector<skat_position> &worlds, const size_t max_worlds
+	)
+{
+	if (i == uc.size())
+	{
+		if (worlds.size() >= max_worlds)
+			return false;
+		skat_position p;
+		skat_infoset_position(is, assigned, p);
+		worlds.push_back(p);
+		return true;
+	}
+	skat_cardset_t c = skat_card2set(uc[i]);
+	for (size_t d = 0; d < 4; d++)
+	{
+		if (!cap[d] || !(is.possible[d] & c))
+			continue;
+		cap[d]--, assigned[d] |= c;
+		bool ok = skat_infoset_enumerate(is, uc, i + 1, cap, assigned, worlds,
+			max_worlds);
+		cap[d]++, assigned[d] &= ~c;
+		if (!ok)
+			return false;
+	}
+	return true;
+}
+
+// enumerates all worlds of the information set; returns 0, if there are
+// more than max_worlds of them
+size_t skat_infoset_enumerate
+	(
+		const skat_infoset &is, std::vector<skat_position> &worlds,
+		const size_t max_worlds
+	)
+{
+	std::vector<size_t> uc;
+	size_t cap[4];
+	skat_cardset_t assigned[4] = { 0, 0, 0, 0 };
+	skat_cardset2vector(is.unknown, uc);
+	for (size_t d = 0; d < 4; d++)
+		cap[d] = is.count[d];
+	worlds.clear();
+	if (!skat_infoset_enumerate(is, uc, 0, cap, assigned, worlds, max_worlds))
+		worlds.clear();
+	return worlds.size();
+}
+
+// number of worlds without regarding the restrictions of possible
+double skat_infoset_worlds
+	(
+		const skat_infoset &is
+	)
+{
+	double worlds = 1.0;
+	size_t n = skat_cardset_size(is.unknown);
+	for (size_t d = 0; d < 3; d++)
+	{
+		for (size_t i = 0; i < is.count[d]; i++)
+			worlds *= (double)(n - i) / (i + 1);
+		n -= is.count[d];
+	}
+	return worlds;
+}
+
+skat_pimc::skat_pimc
+	(skat_pool &p, skat_tt *shared):
+		pool(p), tt(shared), tt_own(false), samples(64), exhaustive(20000),
+		chunk(4),
+		exact_cards(4), max_samples(0), worlds(0), rounds(0), nodes(0),
+		tt_probes(0), tt_hits(0), tt_collisions(0), tt_overwrites(0),
+		tb_hits(0)
+{
+	// all solvers share one transposition table (own or given by the caller)
+	if (tt == NULL)
+		tt = new skat_tt(20), tt_own = true;
+	for (size_t i = 0; i < pool.size(); i++)
+	{
+		solver.push_back(new skat_solver(*tt));
+		state.push_back((((unsigned long long)tmcg_mpz_wrandom_ui()) << 32) ^
+			tmcg_mpz_wrandom_ui() ^ (i + 1));
+	}
+	score.resize(pool.size());
+	solved.resize(pool.size());
+}
+
+void skat_pimc::solve
+	(void *arg, const size_t worker)
+{
+	job *j = (job*)arg;
+	skat_pimc *pm = j->pimc;
+	skat_solver *s = pm->solver[worker];
+	bool null = ((j->is->spiel % 100) == 23);
+	std::vector<size_t> mv;
+	std::vector<int> res;
+	s->limit(j->deadline);
+	for (size_t i = j->first; i < (j->first + j->count); i++)
+	{
+		skat_position p;
+		if (j->deadline && (skat_msec() > j->deadline))
+			break;
+		if (j->worlds != NULL)
+			p = (*j->worlds)[i];
+		else if (!skat_infoset_sample(*j->is, p, pm->state[worker]))
+			continue;
+		if ((s->evaluate(p, mv, res, j->exact) < mv.size()) || s->aborted)
+			break; // deadline exceeded
+		std::vector<size_t> &sc = pm->score[worker];
+		for (size_t k = 0; (k < res.size()) && (k < sc.size()); k++)
+		{
+			bool win = (null) ? (res[k] > 0) : (res[k] > 60);
+			if (j->is->self == j->is->declarer)
+			{
+				sc[k] += (win) ? 1000 : 0;
+				if (j->exact && !null)
+					sc[k] += res[k];
+			}
+			else
+			{
+				sc[k] += (!win) ? 1000 : 0;
+				if (j->exact && !null)
+					sc[k] += 120 - res[k];
+			}
+		}
+		pm->solved[worker]++;
+	}
+	__sync_fetch_and_add(&pm->nodes, s->nodes);
+	__sync_fetch_and_add(&pm->tt_probes, s->tt_probes);
+	__sync_fetch_and_add(&pm->tt_hits, s->tt_hits);
+	__sync_fetch_and_add(&pm->tt_collisions, s->tt_collisions);
+	__sync_fetch_and_add(&pm->tt_overwrites, s->tt_overwrites);
+	__sync_fetch_and_add(&pm->tb_hits, s->tb_hits);
+}
+
+// returns the allowed cards and their scores (higher is better)
+size_t skat_pimc::decide
+	(const skat_infoset &is, const unsigned long long deadline,
+	std::vector<size_t> &mv, std::vector<size_t> &result)
+{
+	size_t t = (is.trick_len > 0) ? is.trick[0] : 99;
+	skat_cardset2vector(skat_legal(t, is.spiel, is.hand[is.self]), mv);
+	result.assign(mv.size(), 0);
+	worlds = 0, nodes = 0, rounds = 0;
+	tt_probes = 0, tt_hits = 0, tt_collisions = 0, tt_overwrites = 0;
+	tb_hits = 0;
+	if (mv.size() < 2)
+		return mv.size();
+	for (size_t i = 0; i < pool.size(); i++)
+		score[i].assign(mv.size(), 0), solved[i] = 0;
+	std::vector<skat_position> all;
+	size_t total = samples;
+	if (skat_infoset_worlds(is) <= exhaustive)
+	{
+		if (skat_infoset_enumerate(is, all, exhaustive) > 0)
+			total = all.size();
+	}
+	bool exact = (skat_cardset_size(is.hand[is.self]) <= exact_cards);
+	// sampling in rounds as long as the next round fits before the deadline
+	for (size_t done = 0; done < std::max(total, max_samples); done += total)
+	{
+		unsigned long long round_start = skat_msec();
+		std::vector<job> jobs;
+		for (size_t first = 0; first < total; first += chunk)
+		{
+			job j;
+			j.pimc = this, j.is = &is;
+			j.worlds = (all.size() > 0) ? &all : NULL;
+			j.first = first, j.count = std::min(chunk, total - first);
+			j.deadline = deadline, j.exact = exact;
+			jobs.push_back(j);
+		}
+		for (size_t i = 0; i < jobs.size(); i++)
+			pool.submit(solve, &jobs[i]);
+		pool.wait();
+		rounds++;
+		unsigned long long now = skat_msec();
+		if ((all.size() > 0) || !deadline ||
+			((now + (now - round_start)) > deadline))
+				break;
+	}
+	for (size_t i = 0; i < pool.size(); i++)
+	{
+		for (size_t k = 0; k < mv.size(); k++)
+			result[k] += score[i][k];
+		worlds += solved[i];
+	}
+	return mv.size();
+}
+
+skat_pimc::~skat_pimc
+	()
+{
+	for (size_t i = 0; i < solver.size(); i++)
+		delete solver[i];
+	if (tt_own)
+		delete tt;
+}
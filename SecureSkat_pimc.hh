@@ -0,0 +1,103 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_pimc_HH
+	#define INCLUDED_SecureSkat_pimc_HH
+
+	#include "SecureSkat_defs.hh"
+	#include "SecureSkat_rule.hh"
+	#include "SecureSkat_search.hh"
+	#include "SecureSkat_pool.hh"
+
+	// what a player knows about the card play (the information set); the
+	// index 3 of count and possible stands for the skat
+	struct skat_infoset
+	{
+		size_t spiel, declarer, self, lead;
+		skat_cardset_t hand[3];		// known cards of each seat (own, ouvert)
+		skat_cardset_t unknown;		// cards not seen so far
+		skat_cardset_t possible[4];	// unknown cards each place can still hold
+		size_t count[4];			// number of unknown cards of each place
+		size_t trick[3], trick_len;	// current trick
+		size_t augen;				// card points of declarer (tricks, skat)
+	};
+
+	unsigned long long skat_random
+		(unsigned long long &state);
+
+	bool skat_infoset_sample
+		(
+			const skat_infoset &is, skat_position &p, unsigned long long &state
+		);
+
+	size_t skat_infoset_enumerate
+		(
+			const skat_infoset &is, std::vector<skat_position> &worlds,
+			const size_t max_worlds
+		);
+
+	double skat_infoset_worlds
+		(
+			const skat_infoset &is
+		);
+
+	// Perfect Information Monte Carlo: solves sampled (or, if there are only
+	// few of them, all) worlds of the information set in parallel and sums
+	// up a score for each allowed card of the player
+	class skat_pimc
+	{
+		private:
+			skat_pool &pool;
+			skat_tt *tt;
+			bool tt_own;
+			std::vector<skat_solver*> solver;
+			std::vector<unsigned long long> state;
+			std::vector< std::vector<size_t> > score;
+			std::vector<size_t> solved;
+
+			struct job
+			{
+				skat_pimc *pimc;
+				const skat_infoset *is;
+				const std::vector<skat_position> *worlds;
+				size_t first, count;
+				unsigned long long deadline;
+				bool exact;
+			};
+
+			static void solve
+				(void *arg, const size_t worker);
+
+		public:
+			size_t samples, exhaustive, chunk, exact_cards;
+			size_t max_samples;		// more samples, if time permits
+			size_t worlds, rounds;
+			unsigned long nodes, tt_probes, tt_hits, tt_collisions;
+			unsigned long tt_overwrites, tb_hits;
+
+			skat_pimc
+				(skat_pool &p, skat_tt *shared = NULL);
+			size_t decide
+				(const skat_infoset &is, const unsigned long long deadline,
+				std::vector<size_t> &mv, std::vector<size_t> &result);
+			~skat_pimc
+				();
+	};
+#endif
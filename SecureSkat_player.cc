@@ -0,0 +1,371 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2002, 2003, 2004, 2005, 2007,
+               2017, 2018, 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_player.hh"
+
+// splitmix64 generator (reproducible, not for cryptography)
+unsigned long long skat_splitmix
+	(unsigned long long &state)
+{
+	unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+skat_ctl_parser::skat_ctl_parser
+	():
+		start(0), scanned(0)
+{
+}
+
+// the next complete line of buffer[0..readed) as message
+bool skat_ctl_parser::next
+	(char *buffer, const size_t readed, skat_ctl_message &msg)
+{
+	if ((scanned < start) || (scanned > readed))
+		scanned = start; // the buffer was reset by the caller
+	if (start >= readed)
+		return false;
+	char *nl = (char*)memchr(buffer + scanned, '\n', readed - scanned);
+	if (nl == NULL)
+	{
+		scanned = readed;
+		return false;
+	}
+	char *p = buffer + start;
+	*nl = 0;
+	msg.argc = 0;
+	while (1)
+	{
+		skat_ctl_token &t = msg.argv[msg.argc++];
+		char *sp = NULL;
+		if (msg.argc < SKAT_CTL_MAXARGS)
+			sp = (char*)memchr(p, ' ', nl - p);
+		t.s = p;
+		if (sp == NULL)
+		{
+			t.len = nl - p;
+			break;
+		}
+		*sp = 0;
+		t.len = sp - p, p = sp + 1;
+	}
+	start = scanned = (nl - buffer) + 1;
+	return true;
+}
+
+void skat_ctl_parser::consume
+	(char *buffer, size_t &readed)
+{
+	if (start > readed)
+		start = readed;
+	readed -= start;
+	if ((readed > 0) && (start > 0))
+		memmove(buffer, buffer + start, readed);
+	scanned = (scanned > start) ? (scanned - start) : 0;
+	start = 0;
+}
+
+skat_ctl_parser::~skat_ctl_parser
+	()
+{
+}
+
+skat_player::skat_player
+	(std::ostream &o, const unsigned long long seed):
+		out(&o), random_state(seed)
+{
+}
+
+unsigned long skat_player::rnd
+	()
+{
+	return (unsigned long)(skat_splitmix(random_state) >> 1);
+}
+
+void skat_player::output
+	(std::ostream &o)
+{
+	out = &o;
+}
+
+skat_player::~skat_player
+	()
+{
+}
+
+skat_random_player::skat_random_player
+	(std::ostream &o, const unsigned long long seed):
+		skat_player(o, seed), pkr_self(100), pkr_pos(100), pkr_spielt(100),
+		spiel_status(0), reize_dran(false), lege_dran(false), gepasst(false)
+{
+}
+
+void skat_random_player::announce
+	()
+{
+	switch ((rnd() + cards.size()) % 6)
+	{
+		case 0:
+			*out << "CMD sagean Ei" << std::endl;
+			break;
+		case 1:
+			*out << "CMD sagean Gr" << std::endl;
+			break;
+		case 2:
+			*out << "CMD sagean Ro" << std::endl;
+			break;
+		case 3:
+			*out << "CMD sagean Sc" << std::endl;
+			break;
+		case 4:
+			*out << "CMD sagean Gd" << std::endl;
+			break;
+		case 5:
+			*out << "CMD sagean Nu" << std::endl;
+			break;
+	}
+}
+
+void skat_random_player::process_command
+	(size_t &readed, char *buffer)
+{
+	skat_ctl_message msg;
+	if (readed == 0)
+		return;
+	// process each complete line (tokens in place)
+	while (parser.next(buffer, readed, msg))
+	{
+	    const skat_ctl_token *par = msg.argv;
+	    if (msg.argc >= 2)
+	    {
+			size_t from = 100;
+			for (size_t j = 0; j < nicks.size(); j++)
+			    if (par[0] == nicks[j])
+					from = j;
+						
+			if ((par[1] == "INIT") && (msg.argc >= 4) && 
+			    (nicks.size() < 3))
+			{
+			    if (par[2] == par[0])
+					pkr_self = nicks.size();
+			    nicks.push_back(par[2].s);
+			    std::string name;
+			    for (size_t j = 0; j < (msg.argc - 3); j++)
+			    {
+					name += par[3 + j].s;
+					if (j < (msg.argc - 4))
+					    name += " ";
+			    }
+			    names.push_back(name);
+			}
+			if ((par[1] == "DONE") && (msg.argc == 2) && (from == pkr_self))
+			{
+				// nothing to do
+			}
+			if ((par[1] == "MISCHEN") && (msg.argc == 2) && (from == pkr_self))
+			{
+				// nothing to do
+			}
+			if ((par[1] == "GEBEN") && (msg.argc == 2) && (from == pkr_self))
+			{
+				// nothing to do
+			}
+			if ((par[1] == "KARTE") && (msg.argc == 3) && (from == pkr_self))
+			{
+				cards.push_back(atoi(par[2].s));
+			}
+			if ((par[1] == "START") && (msg.argc == 3) && (from == pkr_self))
+			{
+			    pkr_pos = atoi(par[2].s);
+			    reize_dran = (pkr_pos == 1) ? true : false;
+			}
+			if ((par[1] == "RAMSCH") && (msg.argc == 2) && (from == pkr_self))
+			{
+				// nothing to do
+			}
+			if ((par[1] == "SPIELT") && (msg.argc == 2) && (pkr_self != 100))
+			{
+				if (par[0] == nicks[0])
+					pkr_spielt = 0;
+				else if (par[0] == nicks[1])
+					pkr_spielt = 1;
+				else if (par[0] == nicks[2])
+					pkr_spielt = 2;
+				if (pkr_spielt == pkr_self)
+				{
+					if (rnd() & 1L)
+						*out << "CMD skat" << std::endl << std::flush;
+					else
+						*out << "CMD hand" << std::endl << std::flush;
+				}
+			}
+			if ((par[1] == "PASSE") && (msg.argc == 2))
+			{
+				if (from == pkr_self)
+					gepasst = true;
+				reize_dran = (!gepasst) ? true : false;
+			}
+			if ((par[1] == "REIZE") && (msg.argc == 3))
+			{
+				if (from == pkr_self)
+					reize_dran = false;
+				else 
+					reize_dran = (!gepasst) ? true : false;
+			}
+			if ((par[1] == "HAND") && (msg.argc == 2) && (from == pkr_spielt))
+			{
+				reize_dran = false;
+				if ((from == pkr_spielt) && (pkr_spielt == pkr_self))
+					announce();
+			}
+			if ((par[1] == "SKAT") && (msg.argc == 2) && (from == pkr_spielt))
+			{
+				reize_dran = false;
+				if ((from == pkr_spielt) && (pkr_spielt == pkr_self))
+				{
+					std::string card0 = skat_type2string(cards[0]);
+					std::string card1 = skat_type2string(cards[1]);
+					cards.erase(cards.begin());
+					cards.erase(cards.begin());
+					*out << "CMD druecke " << 
+						card0.substr(0, card0.length() - 1) << 
+							" " << 
+						card1.substr(0, card1.length() - 1) << 
+						std::endl << std::flush;
+				}
+			}
+			if ((par[1] == "DRUECKE") && (msg.argc == 2) && (from == pkr_spielt))
+			{
+				if ((from == pkr_spielt) && (pkr_spielt == pkr_self))
+					announce();
+			}
+			if ((par[1] == "SAGEAN") && (msg.argc == 3) && 
+				(from == pkr_spielt))
+			{
+				spiel_status = atoi(par[2].s);
+				lege_dran = (pkr_pos == 0) ? true : false;
+			}
+			if ((par[1] == "OUVERT") && (msg.argc == 3) && 
+				(from == pkr_spielt))
+			{
+				ocards.push_back(atoi(par[2].s));
+			}
+			if ((par[1] == "LEGE") && (msg.argc == 3))
+			{
+				size_t card = atoi(par[2].s);
+				stich.push_back(card);
+				lege_dran = ((stich.size() < 3) && 
+					(((from + 1) % 3) == pkr_self)) ? true : false;
+				// remove played card from stack
+				if (par[0] == nicks[pkr_self])
+				{
+					for (std::vector<size_t>::iterator ci = 
+						cards.begin(); ci != cards.end(); ++ci)
+					{
+						if (card == *ci)
+						{
+							cards.erase(ci);
+							break;
+						}
+					}
+    			}
+				// remove played ouvert card from stack
+				if ((par[0] == nicks[pkr_spielt]) && (ocards.size() > 0))
+				{
+					for (std::vector<size_t>::iterator oci = 
+						ocards.begin(); oci != ocards.end(); ++oci)
+					{
+						if (card == *oci)
+						{
+							ocards.erase(oci);
+							break;
+	    				}
+					}
+				}
+			}
+			if ((par[1] == "BSTICH") && (msg.argc == 2))
+			{
+				stich.clear();
+				lege_dran = (par[0] == nicks[pkr_self]) ? true : false;
+			}
+			if ((par[1] == "STOP") && (msg.argc == 2) && (from == pkr_self))
+			{
+				cards.clear(), ocards.clear(), stich.clear();
+				pkr_pos = 100, pkr_spielt = 100;
+				reize_dran = false, lege_dran = false, 
+				gepasst = false;
+			}
+			if ((par[1] == "GEWONNEN") && (msg.argc == 2))
+			{
+				// nothing to do
+			}
+			if ((par[1] == "VERLOREN") && (msg.argc == 2))
+			{
+				// nothing to do
+			}
+			if ((par[1] == "PROTO") && (msg.argc == 3))
+			{
+				// nothing to do
+			}
+		}
+	} // end 2nd while
+	parser.consume(buffer, readed);
+}
+
+void skat_random_player::act
+	(const bool)
+{
+	if (reize_dran)
+	{
+		if (rnd() & 1L)
+			*out << "CMD passe" << std::endl << std::flush;
+		else
+			*out << "CMD reize" << std::endl << std::flush;
+	}
+	else if (lege_dran)
+	{
+		if ((stich.size() == 0) && (cards.size() > 0))
+		{
+			size_t idx = rnd() % cards.size();
+			std::string card = skat_type2string(cards[idx]);
+			*out << "CMD lege " << 
+				card.substr(0, card.length() - 1) << std::endl << std::flush;
+		}
+		else
+		{
+			std::vector<size_t> allowed_cards;
+			skat_legal(stich[0], spiel_status, cards, allowed_cards);
+			assert((allowed_cards.size() > 0));
+			size_t idx = rnd() % allowed_cards.size();
+			std::string card = skat_type2string(allowed_cards[idx]);
+			*out << "CMD lege " << 
+				card.substr(0, card.length() - 1) << std::endl << std::flush;
+		}
+		lege_dran = false;
+	}
+}
+
+skat_random_player::~skat_random_player
+	()
+{
+}
@@ -0,0 +1,144 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2002, 2003, 2004, 2005, 2007,
+               2017, 2018, 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_player_HH
+	#define INCLUDED_SecureSkat_player_HH
+
+	#include "SecureSkat_defs.hh"
+	#include "SecureSkat_rule.hh"
+
+	unsigned long long skat_splitmix
+		(
+			unsigned long long &state
+		);
+
+	// control messages: a line "nick TYPE arg ..." is split at the blanks in
+	// place, i.e., the tokens are null-terminated strings in the buffer of
+	// the caller; the last token contains the rest of a line with more
+	// than SKAT_CTL_MAXARGS tokens
+	#define SKAT_CTL_MAXARGS	32
+
+	struct skat_ctl_token
+	{
+		const char *s;
+		size_t len;
+	};
+
+	static inline bool operator==
+		(
+			const skat_ctl_token &t, const char *s
+		)
+	{
+		return (strcmp(t.s, s) == 0);
+	}
+
+	static inline bool operator==
+		(
+			const skat_ctl_token &t, const std::string &s
+		)
+	{
+		return ((t.len == s.length()) && (memcmp(t.s, s.data(), t.len) == 0));
+	}
+
+	static inline bool operator==
+		(
+			const skat_ctl_token &t, const skat_ctl_token &u
+		)
+	{
+		return ((t.len == u.len) && (memcmp(t.s, u.s, t.len) == 0));
+	}
+
+	struct skat_ctl_message
+	{
+		size_t argc;
+		skat_ctl_token argv[SKAT_CTL_MAXARGS];
+	};
+
+	// incremental parser of the line-framed control messages: between two
+	// calls the caller only appends to the buffer, thus only the new bytes
+	// are scanned for the end of a line; consume() removes the processed
+	// lines from the buffer
+	class skat_ctl_parser
+	{
+		private:
+			size_t start, scanned;
+
+		public:
+			skat_ctl_parser
+				();
+			bool next
+				(char *buffer, const size_t readed, skat_ctl_message &msg);
+			void consume
+				(char *buffer, size_t &readed);
+			~skat_ctl_parser
+				();
+	};
+
+	// a computer player (control program) of the game: it gets the control
+	// messages of skat_game ("nick KARTE 17", "nick LEGE 4", ...) and writes
+	// its commands ("CMD reize", "CMD lege EA", ...) to the output stream;
+	// the random numbers are reproducible for a given seed
+	class skat_player
+	{
+		protected:
+			std::ostream *out;
+			unsigned long long random_state;
+			skat_ctl_parser parser;
+
+			unsigned long rnd
+				();
+
+		public:
+			skat_player
+				(std::ostream &o, const unsigned long long seed);
+			void output
+				(std::ostream &o);
+			virtual void process_command
+				(size_t &readed, char *buffer) = 0;
+			virtual void act
+				(const bool retry) = 0;
+			virtual ~skat_player
+				();
+	};
+
+	// player that chooses bids, games and cards at random
+	class skat_random_player : public skat_player
+	{
+		private:
+			size_t pkr_self, pkr_pos, pkr_spielt, spiel_status;
+			bool reize_dran, lege_dran, gepasst;
+			std::vector<std::string> nicks, names;
+			std::vector<size_t> cards, ocards, stich;
+
+			void announce
+				();
+
+		public:
+			skat_random_player
+				(std::ostream &o, const unsigned long long seed);
+			void process_command
+				(size_t &readed, char *buffer);
+			void act
+				(const bool retry);
+			~skat_random_player
+				();
+	};
+#endif
@@ -0,0 +1,183 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_pool.hh"
+
+size_t skat_pool_cpus
+	()
+{
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return (n > 0) ? n : 1;
+}
+
+skat_pool::skat_pool
+	(const size_t num_threads):
+		queued(0), pending(0), next(0), quit(false), executed(0), stolen(0)
+{
+	size_t n = (num_threads > 0) ? num_threads : skat_pool_cpus();
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&work_cond, NULL);
+	pthread_cond_init(&done_cond, NULL);
+	workers.resize(n);
+	threads.resize(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		queue *q = new queue;
+		pthread_mutex_init(&q->mutex, NULL);
+		queues.push_back(q);
+		workers[i].pool = this, workers[i].id = i;
+	}
+	for (size_t i = 0; i < n; i++)
+	{
+		if (pthread_create(&threads[i], NULL, run, &workers[i]))
+		{
+			perror("skat_pool (pthread_create)");
+			exit(-1);
+		}
+	}
+}
+
+size_t skat_pool::size
+	() const
+{
+	return queues.size();
+}
+
+void skat_pool::submit
+	(skat_task_t fn, void *arg)
+{
+	pthread_mutex_lock(&mutex);
+	size_t w = next++ % queues.size();
+	pthread_mutex_unlock(&mutex);
+	submit(fn, arg, w);
+}
+
+void skat_pool::submit
+	(skat_task_t fn, void *arg, const size_t worker)
+{
+	task t;
+	t.fn = fn, t.arg = arg;
+	queue *q = queues[worker % queues.size()];
+	// count the task before a worker can take it
+	pthread_mutex_lock(&mutex);
+	queued++, pending++;
+	pthread_mutex_unlock(&mutex);
+	pthread_mutex_lock(&q->mutex);
+	q->tasks.push_back(t);
+	pthread_mutex_unlock(&q->mutex);
+	pthread_mutex_lock(&mutex);
+	pthread_cond_signal(&work_cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+// take the newest own task or steal the oldest task of another worker
+bool skat_pool::take
+	(const size_t id, task &t)
+{
+	for (size_t i = 0; i < queues.size(); i++)
+	{
+		queue *q = queues[(id + i) % queues.size()];
+		bool found = false;
+		pthread_mutex_lock(&q->mutex);
+		if (!q->tasks.empty())
+		{
+			if (i == 0)
+			{
+				t = q->tasks.back();
+				q->tasks.pop_back();
+			}
+			else
+			{
+				t = q->tasks.front();
+				q->tasks.pop_front();
+			}
+			found = true;
+		}
+		pthread_mutex_unlock(&q->mutex);
+		if (found)
+		{
+			pthread_mutex_lock(&mutex);
+			queued--;
+			if (i > 0)
+				stolen++;
+			pthread_mutex_unlock(&mutex);
+			return true;
+		}
+	}
+	return false;
+}
+
+void *skat_pool::run
+	(void *arg)
+{
+	worker *w = (worker*)arg;
+	skat_pool *pool = w->pool;
+	while (1)
+	{
+		task t;
+		if (pool->take(w->id, t))
+		{
+			t.fn(t.arg, w->id);
+			pthread_mutex_lock(&pool->mutex);
+			pool->executed++, pool->pending--;
+			if (pool->pending == 0)
+				pthread_cond_broadcast(&pool->done_cond);
+			pthread_mutex_unlock(&pool->mutex);
+			continue;
+		}
+		pthread_mutex_lock(&pool->mutex);
+		while (!pool->quit && (pool->queued == 0))
+			pthread_cond_wait(&pool->work_cond, &pool->mutex);
+		bool quit = (pool->quit && (pool->queued == 0));
+		pthread_mutex_unlock(&pool->mutex);
+		if (quit)
+			break;
+	}
+	return NULL;
+}
+
+// wait until all submitted tasks are finished
+void skat_pool::wait
+	()
+{
+	pthread_mutex_lock(&mutex);
+	while (pending > 0)
+		pthread_cond_wait(&done_cond, &mutex);
+	pthread_mutex_unlock(&mutex);
+}
+
+skat_pool::~skat_pool
+	()
+{
+	pthread_mutex_lock(&mutex);
+	quit = true;
+	pthread_cond_broadcast(&work_cond);
+	pthread_mutex_unlock(&mutex);
+	for (size_t i = 0; i < threads.size(); i++)
+		pthread_join(threads[i], NULL);
+	for (size_t i = 0; i < queues.size(); i++)
+	{
+		pthread_mutex_destroy(&queues[i]->mutex);
+		delete queues[i];
+	}
+	pthread_cond_destroy(&done_cond);
+	pthread_cond_destroy(&work_cond);
+	pthread_mutex_destroy(&mutex);
+}
@@ -0,0 +1,84 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_pool_HH
+	#define INCLUDED_SecureSkat_pool_HH
+
+	#include "SecureSkat_defs.hh"
+
+	// a task gets its argument and the number of the executing worker
+	typedef void (*skat_task_t)(void *arg, const size_t worker);
+
+	// pool of worker threads with one task queue per worker; an idle worker
+	// steals the oldest task from the queue of another worker
+	class skat_pool
+	{
+		private:
+			struct task
+			{
+				skat_task_t fn;
+				void *arg;
+			};
+
+			struct queue
+			{
+				pthread_mutex_t mutex;
+				std::deque<task> tasks;
+			};
+
+			struct worker
+			{
+				skat_pool *pool;
+				size_t id;
+			};
+
+			std::vector<queue*> queues;
+			std::vector<worker> workers;
+			std::vector<pthread_t> threads;
+			pthread_mutex_t mutex;
+			pthread_cond_t work_cond, done_cond;
+			size_t queued, pending, next;
+			bool quit;
+
+			bool take
+				(const size_t id, task &t);
+			static void *run
+				(void *arg);
+
+		public:
+			unsigned long executed, stolen;
+
+			skat_pool
+				(const size_t num_threads = 0);
+			size_t size
+				() const;
+			void submit
+				(skat_task_t fn, void *arg);
+			void submit
+				(skat_task_t fn, void *arg, const size_t worker);
+			void wait
+				();
+			~skat_pool
+				();
+	};
+
+	size_t skat_pool_cpus
+		();
+#endif
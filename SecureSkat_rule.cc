@@ -133,21 +133,6 @@ size_t card_order[][5][18] =
 		}
 	};
 
-size_t skat_idx
-	(
-		size_t ft[5][18], const size_t f, const size_t t, const size_t s
-	)
-{
-	assert (s < 18);
-	assert (f < 5);
-	for (size_t i = s; i < 18; i++)
-	{
-		if (t == ft[f][i])
-			return i;
-	}
-	return 99;
-}
-
 size_t skat_spiel2gwert
 	(
 		const size_t spiel
@@ -177,73 +162,204 @@ size_t skat_spiel2twert
 		return 99;
 }
 
-void init_co
+// masks and orders derived from card_order for each type of game, i.e.,
+// card_row[s][c] is the row (0..3 suit, 4 trump) of card c in game s,
+// card_rank[s][c] is the position of card c in this row (smaller is higher)
+// and row_mask[s][r] contains all cards that follow a card of row r
+static skat_cardset_t row_mask[6][5], points_mask[12];
+static size_t card_row[6][32], card_rank[6][32];
+
+static bool skat_rule_init
+	()
+{
+	for (size_t s = 0; s < 6; s++)
+	{
+		size_t to = 0;
+		if (s == 4)
+			to = 0;	// Null: kein Trumpf
+		else if (s == 5)
+			to = 4; // Grand: 4 Truempfe
+		else
+			to = 11; // Farbspiele: 11 Truempfe
+		for (size_t c = 0; c < 32; c++)
+			card_row[s][c] = 99, card_rank[s][c] = 99;
+		for (size_t r = 0; r < 5; r++)
+		{
+			row_mask[s][r] = 0;
+			for (size_t i = ((r == 4) ? 0 : to); i < 18; i++)
+			{
+				size_t c = card_order[s][r][i];
+				if (c == 99)
+					continue;
+				card_row[s][c] = r, card_rank[s][c] = i;
+				row_mask[s][r] |= skat_card2set(c);
+			}
+		}
+	}
+	for (size_t p = 0; p < 12; p++)
+	{
+		points_mask[p] = 0;
+		for (size_t c = 0; c < 32; c++)
+		{
+			if (skat_pktwert[c] == p)
+				points_mask[p] |= skat_card2set(c);
+		}
+	}
+	return true;
+}
+
+static const bool skat_rule_ready = skat_rule_init();
+
+skat_cardset_t skat_vector2cardset
+	(
+		const std::vector<size_t> &cv
+	)
+{
+	skat_cardset_t cs = 0;
+	for (size_t j = 0; j < cv.size(); j++)
+		cs |= skat_card2set(cv[j]);
+	return cs;
+}
+
+skat_cardset_t skat_stack2cardset
 	(
-		const size_t spiel, size_t co[5][18]
+		const TMCG_OpenStack<VTMF_Card> &os
 	)
 {
-	for (size_t i = 0; i < 5; i++)
-		for (size_t j = 0; j < 18; j++)
-			co[i][j] = card_order[skat_spiel2twert(spiel)][i][j];
+	skat_cardset_t cs = 0;
+	for (size_t j = 0; j < os.size(); j++)
+		cs |= skat_card2set(os[j].first);
+	return cs;
 }
 
-size_t skat_spitzen
+size_t skat_cardset2vector
 	(
-		const size_t spiel, const std::vector<size_t> &cv
+		const skat_cardset_t cs, std::vector<size_t> &cv
 	)
 {
-	TMCG_OpenStack<VTMF_Card> os;
-	for (size_t j = 0; j < cv.size(); j++)
-		os.push(cv[j], VTMF_Card());
-	return skat_spitzen(spiel, os);
+	cv.clear();
+	for (skat_cardset_t rest = cs; rest; rest &= (rest - 1))
+		cv.push_back(__builtin_ctz(rest));
+	return cv.size();
+}
+
+skat_cardset_t skat_trumpmask
+	(
+		const size_t spiel
+	)
+{
+	size_t s = skat_spiel2twert(spiel);
+	if (s == 99)
+		return 0;
+	return row_mask[s][4];
+}
+
+skat_cardset_t skat_suitmask
+	(
+		const size_t spiel, const size_t card
+	)
+{
+	size_t s = skat_spiel2twert(spiel);
+	if ((s == 99) || (card >= 32) || (card_row[s][card] == 99))
+		return 0;
+	return row_mask[s][card_row[s][card]];
+}
+
+size_t skat_cardrow
+	(
+		const size_t spiel, const size_t card
+	)
+{
+	size_t s = skat_spiel2twert(spiel);
+	if ((s == 99) || (card >= 32))
+		return 99;
+	return card_row[s][card];
+}
+
+size_t skat_cardrank
+	(
+		const size_t spiel, const size_t card
+	)
+{
+	size_t s = skat_spiel2twert(spiel);
+	if ((s == 99) || (card >= 32))
+		return 99;
+	return card_rank[s][card];
+}
+
+size_t skat_augen
+	(
+		const skat_cardset_t cs
+	)
+{
+	size_t augen = 0;
+	for (size_t p = 1; p < 12; p++)
+		augen += p * skat_cardset_size(cs & points_mask[p]);
+	return augen;
 }
 
 size_t skat_spitzen
 	(
-		const size_t spiel, const TMCG_OpenStack<VTMF_Card> &os
+		const size_t spiel, const skat_cardset_t cs
 	)
 {
-	size_t co[5][18], sz_cnt = 0;
-	init_co(spiel, co);
+	size_t s = skat_spiel2twert(spiel), sz_cnt = 0;
 	
 	// Null Spiel? Keine Spitzen!
-	if (skat_spiel2gwert(spiel) == 23)
+	if ((s == 4) || (s == 99))
 		return 0;
 	
 	// mit oder ohne Spitzen zaehlen
-	if (os.find(0))
-	{
-		for (size_t sz = 0; sz < 11; sz++)
-		{
-			if (os.find(co[4][sz]))
-					sz_cnt++;
-			else
-				break;
-		}
-	}
-	else
+	bool mit = (cs & skat_card2set(0));
+	for (size_t sz = 0; (sz < 11) && (card_order[s][4][sz] != 99); sz++)
 	{
-		for (size_t sz = 0; sz < 11; sz++)
-		{
-			if (!os.find(co[4][sz]) && (co[4][sz] != 99))
-				sz_cnt++;
-			else
-				break;
-		}
+		if (((cs & skat_card2set(card_order[s][4][sz])) != 0) == mit)
+			sz_cnt++;
+		else
+			break;
 	}
 	return sz_cnt;
 }
 
+size_t skat_spitzen
+	(
+		const size_t spiel, const std::vector<size_t> &cv
+	)
+{
+	return skat_spitzen(spiel, skat_vector2cardset(cv));
+}
+
+size_t skat_spitzen
+	(
+		const size_t spiel, const TMCG_OpenStack<VTMF_Card> &os
+	)
+{
+	return skat_spitzen(spiel, skat_stack2cardset(os));
+}
+
+bool skat_rulectl
+	(
+		const size_t t, const size_t tt, const size_t spiel,
+		const skat_cardset_t hand
+	)
+{
+	size_t s = skat_spiel2twert(spiel);
+	if ((s == 99) || (t >= 32) || (card_row[s][t] == 99))
+		return false;
+	// Farbe bzw. Trumpf angespielt und bedient
+	if ((tt < 32) && (card_row[s][tt] == card_row[s][t]))
+		return true;
+	// ... aber nicht bedient
+	return ((hand & row_mask[s][card_row[s][t]]) == 0);
+}
+
 bool skat_rulectl
 	(
 		const size_t t, const size_t tt, const size_t spiel,
 		const std::vector<size_t> &cv
 	)
 {
-	TMCG_OpenStack<VTMF_Card> os;
-	for (size_t j = 0; j < cv.size(); j++)
-		os.push(cv[j], VTMF_Card());
-	return skat_rulectl(t, tt, spiel, os);
+	return skat_rulectl(t, tt, spiel, skat_vector2cardset(cv));
 }
 
 bool skat_rulectl
@@ -252,52 +368,63 @@ bool skat_rulectl
 		const TMCG_OpenStack<VTMF_Card> &os
 	)
 {
-	size_t co[5][18], to = 0;
-	init_co(spiel, co);
-	
-	if (skat_spiel2gwert(spiel) == 23)
-		to = 0;	// Null: kein Trumpf
-	else if (skat_spiel2gwert(spiel) == 24)
-		to = 4;	// Grand: 4 Truempfe
-	else
-		to = 11; // Farbspiele: 11 Truempfe
+	return skat_rulectl(t, tt, spiel, skat_stack2cardset(os));
+}
+
+// returns the set of cards from hand that are allowed to be played, if the
+// card t has been led (t >= 32 means that no card has been led so far); the
+// set is empty for an invalid game (as skat_rulectl rejects every move)
+skat_cardset_t skat_legal
+	(
+		const size_t t, const size_t spiel, const skat_cardset_t hand
+	)
+{
+	size_t s = skat_spiel2twert(spiel);
+	if (s == 99)
+		return 0;
+	if (t >= 32)
+		return hand;
+	if (card_row[s][t] == 99)
+		return 0;
+	skat_cardset_t bedienen = hand & row_mask[s][card_row[s][t]];
+	return (bedienen != 0) ? bedienen : hand;
+}
 
-	if (skat_idx(co, 4, t, 0) != 99)
+size_t skat_legal
+	(
+		const size_t t, const size_t spiel, const std::vector<size_t> &cv,
+		std::vector<size_t> &allowed_cards
+	)
+{
+	skat_cardset_t legal = skat_legal(t, spiel, skat_vector2cardset(cv));
+	allowed_cards.clear();
+	for (size_t i = 0; i < cv.size(); i++)
 	{
-		// Trumpf angespielt, aber nicht bedient
-		if (skat_idx(co, 4, tt, 0) == 99)
-		{
-			for (size_t i = 0; i < os.size(); i++)
-			{
-				if (skat_idx(co, 4, os[i].first, 0) < 99)
-					return false;
-			}
-			return true;
-		}
-		return true;
+		if (legal & skat_card2set(cv[i]))
+			allowed_cards.push_back(cv[i]);
 	}
+	return allowed_cards.size();
+}
+
+int skat_bstich
+	(
+		const size_t c0, const size_t c1, const size_t c2,
+		const size_t spiel
+	)
+{
+	size_t s = skat_spiel2twert(spiel);
+	if ((s == 99) || (c0 >= 32) || (card_row[s][c0] == 99))
+		return -1;
+	// nur Trumpf oder angespielte Farbe kann den Stich bekommen
+	size_t r = card_row[s][c0], k[3] = { card_rank[s][c0], 99, 99 };
+	if ((c1 < 32) && ((card_row[s][c1] == r) || (card_row[s][c1] == 4)))
+		k[1] = card_rank[s][c1];
+	if ((c2 < 32) && ((card_row[s][c2] == r) || (card_row[s][c2] == 4)))
+		k[2] = card_rank[s][c2];
+	if (k[1] < k[0])
+		return (k[2] < k[1]) ? 2 : 1;
 	else
-	{
-		// Farbe i angespielt ...
-		for (size_t i = 0; i < 4; i++)
-		{
-			if (skat_idx(co, i, t, 0) != 99)
-			{
-				// ... aber nicht bedient
-				if (skat_idx(co, i, tt, to) == 99)
-				{
-					for (size_t j = 0; j < os.size(); j++)
-					{
-						if (skat_idx(co, i, os[j].first, to) < 99)
-							return false;
-					}
-					return true;
-				}
-				return true;
-			}
-		}
-	}
-	return false;
+		return (k[2] < k[0]) ? 2 : 0;
 }
 	
 int skat_bstich
@@ -305,53 +432,160 @@ int skat_bstich
 		const TMCG_OpenStack<VTMF_Card> &os, const size_t spiel
 	)
 {
-	size_t co[5][18];
 	assert (os.size() == 3);
-	init_co(spiel, co);
+	return skat_bstich(os[0].first, os[1].first, os[2].first, spiel);
+}
 
-	if (skat_idx(co, 4, os[0].first, 0) != 99)
+// Hamming weight without the popcnt instruction (vectorizable)
+static inline uint32_t skat_batch_popcount
+	(
+		uint32_t x
+	)
+{
+	x = x - ((x >> 1) & 0x55555555);
+	x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+	x = (x + (x >> 4)) & 0x0F0F0F0F;
+	return (x * 0x01010101) >> 24;
+}
+
+static inline uint32_t skat_batch_augen1
+	(
+		const skat_cardset_t c
+	)
+{
+	return (2 * skat_batch_popcount(c & points_mask[2])) +
+		(3 * skat_batch_popcount(c & points_mask[3])) +
+		(4 * skat_batch_popcount(c & points_mask[4])) +
+		(10 * skat_batch_popcount(c & points_mask[10])) +
+		(11 * skat_batch_popcount(c & points_mask[11]));
+}
+
+void skat_batch_augen
+	(
+		const skat_cardset_t *__restrict cs, const size_t n,
+		uint32_t *__restrict augen
+	)
+{
+	size_t i = 0;
+	for (; (i + SKAT_BATCH_LANES) <= n; i += SKAT_BATCH_LANES)
 	{
-		// Trumpf angespielt
-		if (skat_idx(co, 4, os[1].first, 0) < skat_idx(co, 4, os[0].first, 0))
-		{
-			if (skat_idx(co, 4, os[2].first, 0) < skat_idx(co, 4, os[1].first, 0))
-				return 2;
-			else
-				return 1;
-		}
-		else
-		{
-			if (skat_idx(co, 4, os[2].first, 0) < skat_idx(co, 4, os[0].first, 0))
-				return 2;
-			else
-				return 0;
-		}
+		for (size_t j = i; j < (i + SKAT_BATCH_LANES); j++)
+			augen[j] = skat_batch_augen1(cs[j]);
 	}
+	for (; i < n; i++)
+		augen[i] = skat_batch_augen1(cs[i]);
+}
+
+// rows of the game for the batch kernels and the cards that are
+// considered first for the winner of a trick
+struct skat_batch_game
+{
+	skat_cardset_t row[5], first;
+};
+
+static bool skat_batch_init
+	(
+		const size_t spiel, skat_batch_game &g
+	)
+{
+	size_t s = skat_spiel2twert(spiel);
+	if (s == 99)
+		return false;
+	for (size_t r = 0; r < 5; r++)
+		g.row[r] = row_mask[s][r];
+	if (s == 4)
+		g.first = points_mask[11] | points_mask[4] | points_mask[3];
 	else
+		g.first = row_mask[s][4];
+	return true;
+}
+
+// the cards that follow the led card t (the row of t or nothing)
+static inline skat_cardset_t skat_batch_follow
+	(
+		const skat_batch_game &g, const skat_cardset_t t
+	)
+{
+	return ((0 - (skat_cardset_t)((t & g.row[0]) != 0)) & g.row[0]) |
+		((0 - (skat_cardset_t)((t & g.row[1]) != 0)) & g.row[1]) |
+		((0 - (skat_cardset_t)((t & g.row[2]) != 0)) & g.row[2]) |
+		((0 - (skat_cardset_t)((t & g.row[3]) != 0)) & g.row[3]) |
+		((0 - (skat_cardset_t)((t & g.row[4]) != 0)) & g.row[4]);
+}
+
+static inline skat_cardset_t skat_batch_legal1
+	(
+		const skat_batch_game &g, const skat_cardset_t t,
+		const skat_cardset_t hand
+	)
+{
+	skat_cardset_t bedienen = hand & skat_batch_follow(g, t);
+	return bedienen | (hand & (0 - (skat_cardset_t)(bedienen == 0)));
+}
+
+void skat_batch_legal
+	(
+		const size_t spiel, const skat_cardset_t *__restrict lead,
+		const skat_cardset_t *__restrict hand, const size_t n,
+		skat_cardset_t *__restrict legal
+	)
+{
+	skat_batch_game g;
+	size_t i = 0;
+	if (!skat_batch_init(spiel, g))
 	{
-		// Farbe i angespielt
-		for (size_t i = 0; i < 4; i++)
-		{
-			if (skat_idx(co, i, os[0].first, 0) != 99)
-			{
-				if (skat_idx(co, i, os[1].first, 0) < skat_idx(co, i, os[0].first, 0))
-				{
-					if (skat_idx(co, i, os[2].first, 0) < skat_idx(co, i, os[1].first, 0))
-						return 2;
-					else
-						return 1;
-				}
-				else
-				{
-					if (skat_idx(co, i, os[2].first, 0) < skat_idx(co, i, os[0].first, 0))
-						return 2;
-					else
-						return 0;
-				}
-			}
-		}
+		for (; i < n; i++)
+			legal[i] = hand[i];
+		return;
+	}
+	for (; (i + SKAT_BATCH_LANES) <= n; i += SKAT_BATCH_LANES)
+	{
+		for (size_t j = i; j < (i + SKAT_BATCH_LANES); j++)
+			legal[j] = skat_batch_legal1(g, lead[j], hand[j]);
+	}
+	for (; i < n; i++)
+		legal[i] = skat_batch_legal1(g, lead[i], hand[i]);
+}
+
+// the winner is the lowest card number among the cards of the trick that
+// are trumps or follow suit, where in suit games and Grand the trumps are
+// considered first; in Null aces, kings and queens are considered first,
+// since the order of the numbers is wrong only for jacks and tens
+static inline uint32_t skat_batch_bstich1
+	(
+		const skat_batch_game &g, const skat_cardset_t c0,
+		const skat_cardset_t c1, const skat_cardset_t c2
+	)
+{
+	skat_cardset_t s = (c0 | c1 | c2) & (skat_batch_follow(g, c0) | g.row[4]);
+	skat_cardset_t high = s & g.first;
+	skat_cardset_t cand = high | (s & (0 - (skat_cardset_t)(high == 0)));
+	skat_cardset_t win = cand & (0 - cand);
+	return (1 & (0 - (uint32_t)(win == c1))) | (2 & (0 - (uint32_t)(win == c2)));
+}
+
+void skat_batch_bstich
+	(
+		const size_t spiel, const skat_cardset_t *__restrict c0,
+		const skat_cardset_t *__restrict c1, const skat_cardset_t *__restrict c2,
+		const size_t n, uint32_t *__restrict winner
+	)
+{
+	skat_batch_game g;
+	size_t i = 0;
+	if (!skat_batch_init(spiel, g))
+	{
+		for (; i < n; i++)
+			winner[i] = 0;
+		return;
+	}
+	for (; (i + SKAT_BATCH_LANES) <= n; i += SKAT_BATCH_LANES)
+	{
+		for (size_t j = i; j < (i + SKAT_BATCH_LANES); j++)
+			winner[j] = skat_batch_bstich1(g, c0[j], c1[j], c2[j]);
 	}
-	return -1;
+	for (; i < n; i++)
+		winner[i] = skat_batch_bstich1(g, c0[i], c1[i], c2[i]);
 }
 
 std::string skat_spiel2string
@@ -39,11 +39,75 @@
 		11, 10, 4, 3, 0, 0, 0, 11, 10, 4, 3, 0, 0, 0
 	};
 
+	// set of cards (bit i is set, iff card i is contained in the set)
+	typedef uint32_t skat_cardset_t;
+
+	static inline skat_cardset_t skat_card2set
+		(
+			const size_t card
+		)
+	{
+		return (card < 32) ? ((skat_cardset_t)1 << card) : 0;
+	}
+
+	static inline size_t skat_cardset_size
+		(
+			const skat_cardset_t cs
+		)
+	{
+		return __builtin_popcount(cs);
+	}
+
+	skat_cardset_t skat_vector2cardset
+		(
+			const std::vector<size_t> &cv
+		);
+
+	skat_cardset_t skat_stack2cardset
+		(
+			const TMCG_OpenStack<VTMF_Card> &os
+		);
+
+	size_t skat_cardset2vector
+		(
+			const skat_cardset_t cs, std::vector<size_t> &cv
+		);
+
+	skat_cardset_t skat_trumpmask
+		(
+			const size_t spiel
+		);
+
+	skat_cardset_t skat_suitmask
+		(
+			const size_t spiel, const size_t card
+		);
+
+	size_t skat_cardrow
+		(
+			const size_t spiel, const size_t card
+		);
+
+	size_t skat_cardrank
+		(
+			const size_t spiel, const size_t card
+		);
+
+	size_t skat_augen
+		(
+			const skat_cardset_t cs
+		);
+
 	size_t skat_spiel2gwert
 		(
 			const size_t spiel
 		);
 	
+	size_t skat_spitzen
+		(
+			const size_t spiel, const skat_cardset_t cs
+		);
+
 	size_t skat_spitzen
 		(
 			const size_t spiel, const std::vector<size_t> &cv
@@ -54,6 +118,12 @@
 			const size_t spiel, const TMCG_OpenStack<VTMF_Card> &os
 		);
 	
+	bool skat_rulectl
+		(
+			const size_t t, const size_t tt, const size_t spiel,
+			const skat_cardset_t hand
+		);
+
 	bool skat_rulectl
 		(
 			const size_t t, const size_t tt, const size_t spiel,
@@ -66,10 +136,53 @@
 			const TMCG_OpenStack<VTMF_Card> &os
 		);
 	
+	skat_cardset_t skat_legal
+		(
+			const size_t t, const size_t spiel, const skat_cardset_t hand
+		);
+
+	size_t skat_legal
+		(
+			const size_t t, const size_t spiel, const std::vector<size_t> &cv,
+			std::vector<size_t> &allowed_cards
+		);
+
+	int skat_bstich
+		(
+			const size_t c0, const size_t c1, const size_t c2,
+			const size_t spiel
+		);
+
 	int skat_bstich
 		(
 			const TMCG_OpenStack<VTMF_Card> &os, const size_t spiel
 		);
+
+	// batch kernels for n independent tricks or hands (e.g. the sampled
+	// worlds of a search) as structure of arrays, the cards are given as sets
+	// of one card each; the loops are free of branches and table lookups,
+	// thus the compiler vectorizes them (SKAT_BATCH_LANES entries at once)
+	#define SKAT_BATCH_LANES	8
+
+	void skat_batch_augen
+		(
+			const skat_cardset_t *cs, const size_t n, uint32_t *augen
+		);
+
+	// lead[i] == 0 means that no card has been led in the i-th trick
+	void skat_batch_legal
+		(
+			const size_t spiel, const skat_cardset_t *lead,
+			const skat_cardset_t *hand, const size_t n, skat_cardset_t *legal
+		);
+
+	// winner (0..2 relative to the lead) of n complete tricks
+	void skat_batch_bstich
+		(
+			const size_t spiel, const skat_cardset_t *c0,
+			const skat_cardset_t *c1, const skat_cardset_t *c2, const size_t n,
+			uint32_t *winner
+		);
 	
 	std::string skat_spiel2string
 		(
@@ -0,0 +1,619 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_search.hh"
+
+unsigned long long skat_msec
+	()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return ((unsigned long long)tv.tv_sec * 1000ULL) + (tv.tv_usec / 1000);
+}
+
+void skat_position_init
+	(
+		skat_position &p, const size_t spiel, const size_t declarer,
+		const size_t lead
+	)
+{
+	p.spiel = spiel, p.declarer = declarer, p.lead = lead;
+	p.hand[0] = 0, p.hand[1] = 0, p.hand[2] = 0;
+	p.trick[0] = 99, p.trick[1] = 99, p.trick[2] = 99;
+	p.trick_len = 0, p.augen = 0, p.null_lost = false;
+}
+
+// plays the card for the player to move and completes the trick, if
+// possible; returns false, if the card is not allowed by the rules
+bool skat_position_play
+	(
+		skat_position &p, const size_t card
+	)
+{
+	size_t mover = (p.lead + p.trick_len) % 3;
+	size_t t = (p.trick_len > 0) ? p.trick[0] : 99;
+	if (p.trick_len >= 3)
+		return false;
+	if (!(skat_legal(t, p.spiel, p.hand[mover]) & skat_card2set(card)))
+		return false;
+	p.hand[mover] &= ~skat_card2set(card);
+	p.trick[p.trick_len++] = card;
+	if (p.trick_len == 3)
+	{
+		int bt = skat_bstich(p.trick[0], p.trick[1], p.trick[2], p.spiel);
+		size_t w = (p.lead + bt) % 3;
+		if (w == p.declarer)
+		{
+			p.augen += skat_pktwert[p.trick[0]] + skat_pktwert[p.trick[1]] +
+				skat_pktwert[p.trick[2]];
+			if ((p.spiel % 100) == 23)
+				p.null_lost = true;
+		}
+		p.lead = w, p.trick_len = 0;
+		p.trick[0] = 99, p.trick[1] = 99, p.trick[2] = 99;
+	}
+	return true;
+}
+
+// random numbers for the Zobrist hashes (fixed seed, splitmix64)
+static uint64_t zobrist_hand[3][32], zobrist_trick[3][32], zobrist_lead[3];
+static uint64_t zobrist_game[32], zobrist_declarer[3];
+
+static uint64_t skat_zobrist_next
+	(uint64_t &state)
+{
+	uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+static bool skat_zobrist_init
+	()
+{
+	uint64_t state = 0x5365637572655ULL;
+	for (size_t i = 0; i < 3; i++)
+	{
+		for (size_t c = 0; c < 32; c++)
+		{
+			zobrist_hand[i][c] = skat_zobrist_next(state);
+			zobrist_trick[i][c] = skat_zobrist_next(state);
+		}
+		zobrist_lead[i] = skat_zobrist_next(state);
+		zobrist_declarer[i] = skat_zobrist_next(state);
+	}
+	for (size_t g = 0; g < 32; g++)
+		zobrist_game[g] = skat_zobrist_next(state);
+	return true;
+}
+
+static const bool skat_zobrist_ready = skat_zobrist_init();
+
+// second hash of the remaining cards for detecting collisions of keys
+static inline uint32_t skat_tt_check
+	(const skat_cardset_t hand[3])
+{
+	uint64_t h = ((((uint64_t)hand[0] << 32) | hand[1]) *
+		0xC2B2AE3D27D4EB4FULL) ^ ((uint64_t)hand[2] * 0x165667B19E3779F9ULL);
+	return (uint32_t)(h >> 32);
+}
+
+uint64_t skat_zobrist
+	(
+		const skat_position &p
+	)
+{
+	uint64_t key = zobrist_game[skat_spiel2gwert(p.spiel % 100) % 32] ^
+		zobrist_declarer[p.declarer % 3] ^ zobrist_lead[p.lead % 3];
+	for (size_t i = 0; i < 3; i++)
+	{
+		for (skat_cardset_t rest = p.hand[i]; rest; rest &= (rest - 1))
+			key ^= zobrist_hand[i][__builtin_ctz(rest)];
+	}
+	for (size_t i = 0; (i < p.trick_len) && (i < 3); i++)
+		key ^= zobrist_trick[i][p.trick[i] % 32];
+	return key;
+}
+
+// data word: lower (7 bits), upper (7 bits), best card (5 bits), depth in
+// tricks (4 bits), valid flag (1 bit) and 32 bits check of the cards
+#define SKAT_TT_VALID	((uint64_t)1 << 23)
+
+skat_tt::skat_tt
+	(const size_t bits)
+{
+	size_t n = (size_t)1 << ((bits > 2) ? (bits - 2) : 0);
+	void *mem = NULL;
+	if (posix_memalign(&mem, 64, n * sizeof(bucket)))
+	{
+		perror("skat_tt (posix_memalign)");
+		exit(-1);
+	}
+	table = (bucket*)mem, mask = n - 1;
+	clear();
+}
+
+size_t skat_tt::size
+	() const
+{
+	return (mask + 1) * 4;
+}
+
+void skat_tt::clear
+	()
+{
+	memset(table, 0, (mask + 1) * sizeof(bucket));
+}
+
+// returns 1 for a hit, -1 for a collision (same key, but other cards) and
+// 0 otherwise
+int skat_tt::probe
+	(const uint64_t key, const uint32_t check, int &lower, int &upper,
+	size_t &best) const
+{
+	const bucket &b = table[key & mask];
+	for (size_t i = 0; i < 4; i++)
+	{
+		uint64_t k = __atomic_load_n(&b.w[2 * i], __ATOMIC_RELAXED);
+		uint64_t d = __atomic_load_n(&b.w[(2 * i) + 1], __ATOMIC_RELAXED);
+		if (!(d & SKAT_TT_VALID) || ((k ^ d) != key))
+			continue;
+		if ((uint32_t)(d >> 32) != check)
+			return -1;
+		lower = d & 127, upper = (d >> 7) & 127, best = (d >> 14) & 31;
+		return 1;
+	}
+	return 0;
+}
+
+// stores the bounds in the slot of the same key, an empty slot or the slot
+// with the smallest depth; returns true, if another entry was overwritten
+bool skat_tt::store
+	(const uint64_t key, const uint32_t check, const int lower,
+	const int upper, const size_t best, const size_t depth)
+{
+	bucket &b = table[key & mask];
+	size_t slot = 0, slot_depth = 99;
+	bool other = true;
+	for (size_t i = 0; i < 4; i++)
+	{
+		uint64_t k = __atomic_load_n(&b.w[2 * i], __ATOMIC_RELAXED);
+		uint64_t d = __atomic_load_n(&b.w[(2 * i) + 1], __ATOMIC_RELAXED);
+		if (!(d & SKAT_TT_VALID))
+		{
+			if (slot_depth > 0)
+				slot = i, slot_depth = 0, other = false;
+			continue;
+		}
+		if ((k ^ d) == key)
+		{
+			slot = i, other = false;
+			break;
+		}
+		if (((d >> 19) & 15) < slot_depth)
+			slot = i, slot_depth = (d >> 19) & 15, other = true;
+	}
+	uint64_t d = ((uint64_t)check << 32) | SKAT_TT_VALID |
+		((uint64_t)(depth & 15) << 19) | ((uint64_t)(best & 31) << 14) |
+		((uint64_t)(upper & 127) << 7) | (uint64_t)(lower & 127);
+	__atomic_store_n(&b.w[2 * slot], key ^ d, __ATOMIC_RELAXED);
+	__atomic_store_n(&b.w[(2 * slot) + 1], d, __ATOMIC_RELAXED);
+	return other;
+}
+
+skat_tt::~skat_tt
+	()
+{
+	free(table);
+}
+
+skat_solver::skat_solver
+	(const size_t tt_bits):
+		tt(new skat_tt(tt_bits)), tt_own(true), tb(&skat_tablebase_default()),
+		s_tb_limit(0), s_deadline(0), s_node_limit(0), nodes(0), tt_probes(0),
+		tt_hits(0), tt_collisions(0), tt_stores(0), tt_overwrites(0),
+		tb_hits(0), aborted(false)
+{
+}
+
+skat_solver::skat_solver
+	(skat_tt &shared):
+		tt(&shared), tt_own(false), tb(&skat_tablebase_default()),
+		s_tb_limit(0), s_deadline(0), s_node_limit(0), nodes(0), tt_probes(0),
+		tt_hits(0), tt_collisions(0), tt_stores(0), tt_overwrites(0),
+		tb_hits(0), aborted(false)
+{
+}
+
+void skat_solver::clear
+	()
+{
+	tt->clear();
+}
+
+// uses another endgame tablebase (NULL: none)
+void skat_solver::tablebase
+	(skat_tablebase *t)
+{
+	tb = t;
+}
+
+void skat_solver::limit
+	(const unsigned long long deadline_ms, const unsigned long node_limit)
+{
+	s_deadline = deadline_ms, s_node_limit = node_limit;
+	nodes = 0, tt_probes = 0, tt_hits = 0, tt_collisions = 0;
+	tt_stores = 0, tt_overwrites = 0, tb_hits = 0, aborted = false;
+}
+
+void skat_solver::prepare
+	(const skat_position &p)
+{
+	s_spiel = p.spiel % 100, s_declarer = p.declarer, s_lead = p.lead;
+	s_null = (s_spiel == 23);
+	for (size_t i = 0; i < 3; i++)
+		s_hand[i] = p.hand[i], s_trick[i] = p.trick[i];
+	s_trick_len = p.trick_len;
+	s_tb_limit = (tb != NULL) ? tb->limit(s_spiel) : 0;
+	for (size_t r = 0; r < 5; r++)
+	{
+		s_rowmask[r] = 0;
+		for (size_t k = 0; k < 18; k++)
+			s_order[r][k] = 99;
+	}
+	for (size_t c = 0; c < 32; c++)
+	{
+		s_row[c] = skat_cardrow(s_spiel, c);
+		s_rank[c] = skat_cardrank(s_spiel, c);
+		if (s_row[c] < 5)
+		{
+			s_rowmask[s_row[c]] |= skat_card2set(c);
+			s_order[s_row[c]][s_rank[c]] = c;
+		}
+	}
+	// the stored values depend on the game and on the declarer
+	s_base = zobrist_game[skat_spiel2gwert(s_spiel) % 32] ^
+		zobrist_declarer[s_declarer % 3];
+	s_hash = 0;
+	for (size_t i = 0; i < 3; i++)
+	{
+		for (skat_cardset_t rest = s_hand[i]; rest; rest &= (rest - 1))
+			s_hash ^= zobrist_hand[i][__builtin_ctz(rest)];
+	}
+	for (size_t i = 0; i < s_trick_len; i++)
+		s_hash ^= zobrist_trick[i][s_trick[i] % 32];
+}
+
+skat_cardset_t skat_solver::legal
+	(const size_t mover) const
+{
+	if (s_trick_len == 0)
+		return s_hand[mover];
+	skat_cardset_t bedienen = s_hand[mover] & s_rowmask[s_row[s_trick[0]]];
+	return (bedienen != 0) ? bedienen : s_hand[mover];
+}
+
+size_t skat_solver::winner
+	() const
+{
+	size_t r = s_row[s_trick[0]], w = 0, k = s_rank[s_trick[0]];
+	for (size_t i = 1; i < s_trick_len; i++)
+	{
+		size_t c = s_trick[i];
+		if (((s_row[c] == r) || (s_row[c] == 4)) && (s_rank[c] < k))
+			w = i, k = s_rank[c];
+	}
+	return (s_lead + w) % 3;
+}
+
+// generates the moves of the player to move in a reasonable order; cards
+// of the same row without a remaining card in between and with the same
+// value (Augen) are equivalent, thus only one of them is considered
+size_t skat_solver::moves
+	(const size_t mover, size_t *mv, const size_t hint) const
+{
+	skat_cardset_t l = legal(mover);
+	skat_cardset_t alive = s_hand[0] | s_hand[1] | s_hand[2];
+	for (size_t i = 0; i < s_trick_len; i++)
+		alive |= skat_card2set(s_trick[i]);
+	size_t n = 0, score[10];
+	size_t w = 0, wr = 99, wk = 99;
+	if (s_trick_len > 0)
+	{
+		w = winner(), wr = s_row[s_trick[0]];
+		wk = s_rank[s_trick[(w + 3 - s_lead) % 3]];
+	}
+	bool decl = (mover == s_declarer), partner = false;
+	if (s_trick_len > 0)
+		partner = ((w == s_declarer) == decl);
+	for (skat_cardset_t rest = l; rest; rest &= (rest - 1))
+	{
+		size_t c = __builtin_ctz(rest);
+		// skip c, if the next higher remaining card is an equivalent one
+		bool equivalent = false;
+		for (size_t k = s_rank[c]; k-- > 0; )
+		{
+			size_t cc = s_order[s_row[c]][k];
+			if ((cc == 99) || !(skat_card2set(cc) & alive))
+				continue;
+			if ((skat_card2set(cc) & l) &&
+				(s_null || (skat_pktwert[cc] == skat_pktwert[c])))
+			{
+				equivalent = true;
+			}
+			break;
+		}
+		if (equivalent && (c != hint))
+			continue;
+		// heuristic score for move ordering
+		size_t sc = 0;
+		bool beats = false;
+		if (s_trick_len > 0)
+		{
+			beats = (((s_row[c] == wr) || (s_row[c] == 4)) &&
+				(s_rank[c] < wk));
+		}
+		if (s_null)
+		{
+			if (s_trick_len == 0)
+				sc = s_rank[c];
+			else if (!beats && (decl || (w == s_declarer)))
+				sc = 1000 - s_rank[c];
+			else
+				sc = s_rank[c];
+		}
+		else
+		{
+			if (s_trick_len == 0)
+				sc = 100 - s_rank[c] + skat_pktwert[c];
+			else if (beats && !partner)
+				sc = 1000 + skat_pktwert[c];
+			else if (partner)
+				sc = 500 + skat_pktwert[c];
+			else
+				sc = 100 - skat_pktwert[c];
+		}
+		if (c == hint)
+			sc = 10000;
+		// insertion sort by descending score
+		size_t j = n++;
+		while ((j > 0) && (score[j - 1] < sc))
+		{
+			score[j] = score[j - 1], mv[j] = mv[j - 1];
+			j--;
+		}
+		score[j] = sc, mv[j] = c;
+	}
+	return n;
+}
+
+int skat_solver::alphabeta
+	(int alpha, int beta)
+{
+	nodes++;
+	if (aborted)
+		return 0;
+	if ((nodes & 1023) == 0)
+	{
+		if ((s_node_limit && (nodes > s_node_limit)) ||
+			(s_deadline && (skat_msec() > s_deadline)))
+		{
+			aborted = true;
+			return 0;
+		}
+	}
+	size_t mover = (s_lead + s_trick_len) % 3, hint = 99;
+	int lower = 0, upper = 0;
+	uint64_t key = 0;
+	uint32_t check = 0;
+	if (s_trick_len == 0)
+	{
+		skat_cardset_t all = s_hand[0] | s_hand[1] | s_hand[2];
+		if (!all)
+			return (s_null) ? 1 : 0;
+		upper = (s_null) ? 1 : skat_augen(all);
+		if (upper <= alpha)
+			return upper;
+		if (lower >= beta)
+			return lower;
+		// exact value of the last tricks from the tablebase
+		if (skat_cardset_size(s_hand[s_lead]) <= s_tb_limit)
+		{
+			int v = tb->lookup(s_spiel, s_declarer, s_lead, s_hand);
+			if (v >= 0)
+			{
+				tb_hits++;
+				return v;
+			}
+		}
+		// transposition table lookup (only at the beginning of a trick)
+		int tl = 0, tu = 0, r = 0;
+		key = s_base ^ s_hash ^ zobrist_lead[s_lead];
+		check = skat_tt_check(s_hand);
+		tt_probes++;
+		r = tt->probe(key, check, tl, tu, hint);
+		if (r < 0)
+			tt_collisions++;
+		else if (r > 0)
+		{
+			tt_hits++;
+			lower = tl, upper = tu;
+			if (lower >= beta)
+				return lower;
+			if ((upper <= alpha) || (lower == upper))
+				return upper;
+			alpha = std::max(alpha, lower);
+			beta = std::min(beta, upper);
+		}
+	}
+	size_t mv[10];
+	size_t n = moves(mover, mv, hint);
+	bool max = (mover == s_declarer);
+	int best_value = (max) ? -1 : 1000, a = alpha, b = beta;
+	size_t best_card = mv[0];
+	for (size_t i = 0; i < n; i++)
+	{
+		size_t c = mv[i];
+		int v = 0;
+		s_hand[mover] &= ~skat_card2set(c);
+		s_hash ^= zobrist_hand[mover][c] ^ zobrist_trick[s_trick_len][c];
+		s_trick[s_trick_len++] = c;
+		if (s_trick_len == 3)
+		{
+			size_t w = winner(), old_lead = s_lead;
+			size_t t0 = s_trick[0], t1 = s_trick[1], t2 = s_trick[2];
+			uint64_t th = zobrist_trick[0][t0] ^ zobrist_trick[1][t1] ^
+				zobrist_trick[2][t2];
+			s_trick_len = 0, s_lead = w, s_hash ^= th;
+			if (s_null)
+				v = (w == s_declarer) ? 0 : alphabeta(a, b);
+			else
+			{
+				int gain = 0;
+				if (w == s_declarer)
+					gain = skat_pktwert[t0] + skat_pktwert[t1] +
+						skat_pktwert[t2];
+				v = gain + alphabeta(a - gain, b - gain);
+			}
+			s_lead = old_lead, s_trick_len = 3, s_hash ^= th;
+			s_trick[0] = t0, s_trick[1] = t1, s_trick[2] = t2;
+		}
+		else
+			v = alphabeta(a, b);
+		s_trick_len--;
+		s_hand[mover] |= skat_card2set(c);
+		s_hash ^= zobrist_hand[mover][c] ^ zobrist_trick[s_trick_len][c];
+		if (aborted)
+			return 0;
+		if (max)
+		{
+			if (v > best_value)
+				best_value = v, best_card = c;
+			if (v > a)
+				a = v;
+		}
+		else
+		{
+			if (v < best_value)
+				best_value = v, best_card = c;
+			if (v < b)
+				b = v;
+		}
+		if (a >= b)
+			break;
+	}
+	// transposition table update (fail-soft bounds)
+	if (s_trick_len == 0)
+	{
+		if (best_value <= alpha)
+			upper = best_value;
+		else if (best_value >= beta)
+			lower = best_value;
+		else
+			lower = best_value, upper = best_value;
+		size_t depth = skat_cardset_size(s_hand[s_lead]);
+		if (tt->store(key, check, lower, upper, best_card, depth))
+			tt_overwrites++;
+		tt_stores++;
+	}
+	return best_value;
+}
+
+int skat_solver::value
+	(const skat_position &p)
+{
+	if (((p.spiel % 100) == 23) && p.null_lost)
+		return 0;
+	prepare(p);
+	if (s_null)
+		return alphabeta(-1, 2);
+	return p.augen + alphabeta(-1, 121);
+}
+
+// search with a window on the final card points (e.g. 60, 61 for winning)
+int skat_solver::value
+	(const skat_position &p, const int alpha, const int beta)
+{
+	if (((p.spiel % 100) == 23) && p.null_lost)
+		return 0;
+	prepare(p);
+	if (s_null)
+		return alphabeta(alpha, beta);
+	return p.augen + alphabeta(alpha - (int)p.augen, beta - (int)p.augen);
+}
+
+bool skat_solver::wins
+	(const skat_position &p)
+{
+	if ((p.spiel % 100) == 23)
+		return (value(p, 0, 1) > 0);
+	return (value(p, 60, 61) > 60);
+}
+
+// computes the value of each allowed card of the player to move; if exact
+// is false, then for suit and Grand games only the bound with respect to
+// winning is computed (the result is greater than 60, iff declarer wins)
+size_t skat_solver::evaluate
+	(const skat_position &p, std::vector<size_t> &mv,
+	std::vector<int> &result, const bool exact)
+{
+	size_t mover = (p.lead + p.trick_len) % 3;
+	size_t t = (p.trick_len > 0) ? p.trick[0] : 99;
+	skat_cardset2vector(skat_legal(t, p.spiel, p.hand[mover]), mv);
+	result.clear();
+	for (size_t i = 0; i < mv.size(); i++)
+	{
+		skat_position q = p;
+		skat_position_play(q, mv[i]);
+		int v = (exact || ((p.spiel % 100) == 23)) ? value(q) : value(q, 60, 61);
+		// the value of an aborted search is meaningless
+		if (aborted)
+			break;
+		result.push_back(v);
+	}
+	return result.size();
+}
+
+// returns the best card for the player to move (declarer maximizes)
+size_t skat_solver::best
+	(const skat_position &p, int &result)
+{
+	std::vector<size_t> mv;
+	std::vector<int> res;
+	size_t mover = (p.lead + p.trick_len) % 3, card = 99;
+	evaluate(p, mv, res);
+	for (size_t i = 0; i < res.size(); i++)
+	{
+		if ((card == 99) ||
+			((mover == p.declarer) && (res[i] > result)) ||
+			((mover != p.declarer) && (res[i] < result)))
+		{
+			card = mv[i], result = res[i];
+		}
+	}
+	return card;
+}
+
+skat_solver::~skat_solver
+	()
+{
+	if (tt_own)
+		delete tt;
+}
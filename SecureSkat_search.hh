@@ -0,0 +1,155 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_search_HH
+	#define INCLUDED_SecureSkat_search_HH
+
+	#include "SecureSkat_defs.hh"
+	#include "SecureSkat_rule.hh"
+	#include "SecureSkat_tb.hh"
+
+	// a position of the card play with perfect information (double dummy),
+	// the player to move is (lead + trick_len) % 3
+	struct skat_position
+	{
+		size_t spiel;				// announced game (only spiel % 100 matters)
+		size_t declarer;			// seat (0..2) of the declarer
+		size_t lead;				// seat that has led the current trick
+		skat_cardset_t hand[3];		// cards still held by each seat
+		size_t trick[3];			// cards of the current trick
+		size_t trick_len;			// number of cards in the current trick
+		size_t augen;				// card points taken by declarer (with skat)
+		bool null_lost;				// Null: declarer has taken a trick
+	};
+
+	void skat_position_init
+		(
+			skat_position &p, const size_t spiel, const size_t declarer,
+			const size_t lead
+		);
+
+	bool skat_position_play
+		(
+			skat_position &p, const size_t card
+		);
+
+	// transposition table that can be shared by the solvers of several threads
+	// without locks: the entries are addressed by Zobrist hashes (remaining
+	// cards of each seat, current trick, player to move, game and declarer),
+	// four of them fill a cache line, and each entry consists of the two words
+	// key ^ data and data, thus a torn write of another thread is detected
+	class skat_tt
+	{
+		private:
+			struct bucket
+			{
+				uint64_t w[8];
+			};
+
+			bucket *table;
+			size_t mask;
+
+		public:
+			skat_tt
+				(const size_t bits = 20);
+			size_t size
+				() const;
+			void clear
+				();
+			int probe
+				(const uint64_t key, const uint32_t check, int &lower,
+				int &upper, size_t &best) const;
+			bool store
+				(const uint64_t key, const uint32_t check, const int lower,
+				const int upper, const size_t best, const size_t depth);
+			~skat_tt
+				();
+	};
+
+	uint64_t skat_zobrist
+		(
+			const skat_position &p
+		);
+
+	// alpha-beta solver with transposition table, move ordering and pruning
+	// of equivalent cards that stops at the boundary of the endgame tablebase
+	// (if available); the value of a position is the number of card
+	// points (0..120) that the declarer finally gets or, for Null games,
+	// 1 if the declarer takes no trick and 0 otherwise
+	class skat_solver
+	{
+		private:
+			skat_tt *tt;
+			bool tt_own;
+			skat_tablebase *tb;
+			size_t s_tb_limit;
+			uint64_t s_base, s_hash;
+			size_t s_spiel, s_declarer, s_lead, s_trick_len, s_trick[3];
+			bool s_null;
+			skat_cardset_t s_hand[3], s_rowmask[5];
+			size_t s_row[32], s_rank[32], s_order[5][18];
+			unsigned long long s_deadline;
+			unsigned long s_node_limit;
+
+			void prepare
+				(const skat_position &p);
+			skat_cardset_t legal
+				(const size_t mover) const;
+			size_t winner
+				() const;
+			size_t moves
+				(const size_t mover, size_t *mv, const size_t hint) const;
+			int alphabeta
+				(int alpha, int beta);
+
+		public:
+			unsigned long nodes, tt_probes, tt_hits, tt_collisions;
+			unsigned long tt_stores, tt_overwrites, tb_hits;
+			bool aborted;
+
+			skat_solver
+				(const size_t tt_bits = 18);
+			skat_solver
+				(skat_tt &shared);
+			void clear
+				();
+			void tablebase
+				(skat_tablebase *t);
+			void limit
+				(const unsigned long long deadline_ms,
+				const unsigned long node_limit = 0);
+			int value
+				(const skat_position &p);
+			int value
+				(const skat_position &p, const int alpha, const int beta);
+			bool wins
+				(const skat_position &p);
+			size_t best
+				(const skat_position &p, int &result);
+			size_t evaluate
+				(const skat_position &p, std::vector<size_t> &mv,
+				std::vector<int> &result, const bool exact = true);
+			~skat_solver
+				();
+	};
+
+	unsigned long long skat_msec
+		();
+#endif
@@ -0,0 +1,120 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+// Self-play without cryptography: the computer players play a number of
+// games against each other at a simulated table (see skat_sim).
+// usage: SecureSkat_selfplay [games] [seed] [player0] [player1] [player2]
+// with the players "random", "ai" or "ai:engine" (pimc, ismcts, heuristik)
+
+#include "SecureSkat_defs.hh"
+#include "SecureSkat_player.hh"
+#include "SecureSkat_aiplayer.hh"
+#include "SecureSkat_sim.hh"
+
+int main (int argc, char **argv)
+{
+	size_t games = 1000;
+	unsigned long long seed = 0;
+	std::string spec[3] = { "ai", "random", "random" };
+	if (argc > 1)
+		games = strtoul(argv[1], NULL, 10);
+	if (argc > 2)
+		seed = strtoull(argv[2], NULL, 10);
+	for (size_t i = 0; (i < 3) && ((int)i < (argc - 3)); i++)
+		spec[i] = argv[3 + i];
+
+	// initialize LibTMCG (random numbers of the search engines)
+	if (!init_libTMCG())
+	{
+		std::cerr << "Initialization of LibTMCG failed!" << std::endl;
+		return EXIT_FAILURE;
+	}
+	// Bedenkzeit, Spielzeit und Threads wie bei SecureSkat_ai
+	unsigned long long bedenkzeit = 0, spielzeit = SKAT_GAME_TIME;
+	if (getenv("SECURESKAT_BEDENKZEIT") != NULL)
+		bedenkzeit = strtoul(getenv("SECURESKAT_BEDENKZEIT"), NULL, 10);
+	if (getenv("SECURESKAT_SPIELZEIT") != NULL)
+		spielzeit = strtoul(getenv("SECURESKAT_SPIELZEIT"), NULL, 10);
+	skat_pool *pool = NULL;
+	if (getenv("SECURESKAT_THREADS") != NULL)
+		pool = new skat_pool(strtoul(getenv("SECURESKAT_THREADS"), NULL, 10));
+	else
+		pool = new skat_pool();
+	std::ostream nirvana(NULL); // debug output of the players is discarded
+	skat_player *player[3];
+	for (size_t i = 0; i < 3; i++)
+	{
+		unsigned long long ps = seed + i + 1;
+		if (spec[i] == "random")
+			player[i] = new skat_random_player(std::cout, ps);
+		else if ((spec[i] == "ai") || (spec[i].find("ai:") == 0))
+		{
+			std::string engine = (spec[i] == "ai") ? "pimc" : spec[i].substr(3);
+			skat_ai_player *ai = new skat_ai_player(std::cout, ps, *pool,
+				engine, bedenkzeit, spielzeit);
+			ai->debug(nirvana);
+			player[i] = ai;
+		}
+		else
+		{
+			std::cerr << "SecureSkat_selfplay: unknown player \"" << spec[i] <<
+				"\"" << std::endl;
+			for (size_t j = 0; j < i; j++)
+				delete player[j];
+			delete pool;
+			return EXIT_FAILURE;
+		}
+	}
+
+	skat_sim *sim = new skat_sim(player[0], player[1], player[2], seed);
+	size_t declared[3] = { 0, 0, 0 }, won[3] = { 0, 0, 0 }, none = 0;
+	unsigned long long start = skat_msec();
+	for (size_t g = 0; g < games; g++)
+	{
+		skat_sim_result r;
+		if (!sim->play(r))
+			continue;
+		if (r.declarer > 2)
+		{
+			none++;
+			continue;
+		}
+		declared[r.declarer]++;
+		if (r.gewonnen)
+			won[r.declarer]++;
+	}
+	sim->done();
+	unsigned long long ms = skat_msec() - start;
+
+	std::cout << "games: " << sim->games << " (" << none << " without bid, " <<
+		sim->aborted << " aborted) in " << ms << " ms = " <<
+		((1000.0 * sim->games) / ((ms > 0) ? ms : 1)) << " games/s" << std::endl;
+	for (size_t i = 0; i < 3; i++)
+	{
+		std::cout << "player " << i << " (" << spec[i] << "): " << declared[i] <<
+			" games, " << won[i] << " won, " << sim->pkt_sum[i] << " points" <<
+			std::endl;
+	}
+	delete sim;
+	for (size_t i = 0; i < 3; i++)
+		delete player[i];
+	delete pool;
+	return EXIT_SUCCESS;
+}
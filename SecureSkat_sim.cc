@@ -0,0 +1,632 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_sim.hh"
+
+unsigned long long skat_usec
+	()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return ((unsigned long long)tv.tv_sec * 1000000ULL) + tv.tv_usec;
+}
+
+skat_sim::skat_sim
+	(skat_player *p0, skat_player *p1, skat_player *p2,
+	const unsigned long long seed):
+		random_state(seed), games(0), aborted(0)
+{
+	players.push_back(p0), players.push_back(p1), players.push_back(p2);
+	for (size_t i = 0; i < 3; i++)
+	{
+		std::ostringstream nick;
+		nick << "sim" << i;
+		nicks.push_back(nick.str());
+		pending.push_back("");
+		output.push_back(new std::ostringstream());
+		players[i]->output(*output[i]);
+		pkt_sum[i] = 0, decisions[i] = 0, decision_usec[i] = 0;
+	}
+	for (size_t i = 0; i < 3; i++)
+	{
+		for (size_t j = 0; j < 3; j++)
+		{
+			std::ostringstream ost;
+			ost << nicks[i] << " INIT " << nicks[j] << " " << nicks[j];
+			send(i, ost.str());
+		}
+	}
+}
+
+// mischen und geben wie skat_geben: 3 Karten, Skat, 4 Karten, 3 Karten;
+// with duplicate the first hand goes to VH, the second to MH and so on
+void skat_sim::deal
+	(unsigned long long &state, const bool duplicate)
+{
+	size_t d[32];
+	for (size_t i = 0; i < 32; i++)
+		d[i] = i;
+	for (size_t i = 32; i > 1; i--)
+		std::swap(d[i - 1], d[skat_splitmix(state) % i]);
+	size_t k = 0;
+	skat_cardset_t s[3] = { 0, 0, 0 };
+	skat = 0;
+	for (size_t i = 0; i < 3; i++)
+		for (size_t j = 0; j < 3; j++)
+			s[i] |= skat_card2set(d[k++]);
+	for (size_t j = 0; j < 2; j++)
+		skat |= skat_card2set(d[k++]);
+	for (size_t i = 0; i < 3; i++)
+		for (size_t j = 0; j < 4; j++)
+			s[i] |= skat_card2set(d[k++]);
+	for (size_t i = 0; i < 3; i++)
+		for (size_t j = 0; j < 3; j++)
+			s[i] |= skat_card2set(d[k++]);
+	assert(k == 32);
+	for (size_t i = 0; i < 3; i++)
+		hand[i] = s[duplicate ? ((i + p) % 3) : i];
+}
+
+void skat_sim::send
+	(const size_t i, const std::string &line)
+{
+	pending[i] += line;
+	pending[i] += "\n";
+}
+
+void skat_sim::broadcast
+	(const std::string &line)
+{
+	for (size_t i = 0; i < 3; i++)
+		send(i, line);
+}
+
+// die Nachrichten an den Spieler i uebergeben, ihn handeln lassen und seine
+// Kommandos (ohne "CMD ") einsammeln
+void skat_sim::deliver
+	(const size_t i, const bool retry, std::vector<std::string> &commands)
+{
+	unsigned long long t = skat_usec();
+	if (pending[i].length() > 0)
+	{
+		size_t readed = pending[i].length();
+		assert(readed < sizeof(buffer[i]));
+		memcpy(buffer[i], pending[i].c_str(), readed);
+		pending[i] = "";
+		players[i]->process_command(readed, buffer[i]);
+	}
+	players[i]->act(retry);
+	std::string out = output[i]->str();
+	output[i]->str("");
+	size_t pos = 0, ei;
+	while ((ei = out.find("\n", pos)) != out.npos)
+	{
+		std::string cmd = out.substr(pos, ei - pos);
+		pos = ei + 1;
+		if (cmd.find("CMD ") != 0)
+			continue;
+		cmd = cmd.substr(4, cmd.length() - 4);
+		// trim spaces at end of std::string
+		while ((cmd.length() > 0) && (cmd[cmd.length() - 1] == ' '))
+			cmd = cmd.substr(0, cmd.length() - 1);
+		commands.push_back(cmd);
+	}
+	// a decision is the time from the messages until the command
+	if (commands.size() > 0)
+	{
+		decisions[i]++;
+		decision_usec[i] += skat_usec() - t;
+	}
+}
+
+// Reizen wie in skat_game: reiz_status bestimmt, wer dran ist
+bool skat_sim::bid
+	(const size_t i, const bool pass)
+{
+	size_t who_biding = 100;
+	switch (reiz_status)
+	{
+		case 1:
+		case 4:
+		case 7:
+		case 10:
+			who_biding = vh;
+			break;
+		case 0:
+		case 2:
+		case 9:
+			who_biding = mh;
+			break;
+		case 3:
+		case 5:
+		case 6:
+		case 8:
+			who_biding = hh;
+			break;
+	}
+	if (who_biding != i)
+		return false;
+	if (pass)
+	{
+		switch (reiz_status)
+		{
+			case 0: // MH passt (sofort)
+				reiz_status = 3;
+				break;
+			case 1: // VH passt (nach Reizen MH)
+				reiz_status = 8;
+				break;
+			case 2: // MH passt (nach dem Reizen)
+				reiz_status = 6;
+				break;
+			case 3: // HH passt (sofort)
+				reiz_status = 10;
+				break;
+			case 4: // VH passt (nach Reizen HH)
+			case 7: // VH passt (nach Passen MH)
+			case 9: // MH passt (nach dem Passen VH)
+				reiz_status = 14;
+				break;
+			case 5: // HH passt (nach dem Reizen)
+			case 6: // HH passt (nach dem Reizen)
+				reiz_status = 12;
+				break;
+			case 8: // HH passt (nach dem Passen VH)
+				reiz_status = 13;
+				break;
+			case 10: // VH passt (am Schluss)
+				reiz_status = 11;
+				break;
+		}
+		broadcast(nicks[i] + " PASSE");
+		return true;
+	}
+	// Reizen oder Ja-sagen; hoeher als der letzte Reizwert geht es nicht
+	bool next = ((reiz_status == 0) || (reiz_status == 2) ||
+		(reiz_status == 3) || (reiz_status == 5) || (reiz_status == 6) ||
+		(reiz_status == 8) || (reiz_status == 10));
+	if (next && ((reiz_counter + 1) >=
+		(sizeof(skat_reizwert) / sizeof(skat_reizwert[0]))))
+			return false;
+	switch (reiz_status)
+	{
+		case 0: // MH reizt (zu Beginn)
+		case 2: // MH reizt (weiter)
+			reiz_status = 1;
+			break;
+		case 1: // VH sagt ja (nach Reizen MH)
+			reiz_status = 2;
+			break;
+		case 3: // HH reizt (nach sofort Passen MH, oder Reizen VH)
+		case 5:
+			reiz_status = 4;
+			break;
+		case 4: // VH sagt ja (nach Passen MH, Reizen HH)
+			reiz_status = 5;
+			break;
+		case 6: // HH reizt (nach Passen MH)
+			reiz_status = 7;
+			break;
+		case 7: // VH sagt ja (nach Passen MH, Reizen HH)
+			reiz_status = 6;
+			break;
+		case 8: // HH reizt (nach Passen VH)
+			reiz_status = 9;
+			break;
+		case 9: // MH sagt ja (nach Passen VH)
+			reiz_status = 8;
+			break;
+		case 10: // VH reizt (nach sofort Passen MH, sofort Passen HH)
+			reiz_status = 12;
+			break;
+	}
+	if (next)
+		reiz_counter++;
+	std::ostringstream ost;
+	ost << nicks[i] << " REIZE " << skat_reizwert[reiz_counter];
+	broadcast(ost.str());
+	return true;
+}
+
+// Kommando msg des Spielers i pruefen und ausfuehren
+bool skat_sim::command
+	(const size_t i, const std::string &msg)
+{
+	std::string word = msg, par = "";
+	size_t mi = msg.find(" ");
+	if (mi != msg.npos)
+	{
+		word = msg.substr(0, mi);
+		par = msg.substr(mi + 1, msg.length() - (mi + 1));
+	}
+	std::transform(word.begin(), word.end(), word.begin(), ::tolower);
+	if ((word == "passe") || (word == "pass"))
+		return bid(i, true);
+	if ((word == "reize") || (word == "bid"))
+		return bid(i, false);
+	if ((word == "hand") || (word == "skat"))
+	{
+		if ((reiz_status < 100) || (reiz_status > 200) || (i != spiel_allein))
+			return false;
+		hand_spiel = (word == "hand"), reiz_status += 100;
+		if (!hand_spiel)
+		{
+			std::vector<size_t> sk;
+			skat_cardset2vector(skat, sk);
+			for (size_t j = 0; j < sk.size(); j++)
+			{
+				std::ostringstream ost;
+				ost << nicks[i] << " KARTE " << sk[j];
+				send(i, ost.str());
+			}
+			hand[i] |= skat, skat = 0;
+			broadcast(nicks[i] + " SKAT");
+		}
+		else
+			broadcast(nicks[i] + " HAND");
+		return true;
+	}
+	if ((word == "druecke") || (word == "push"))
+	{
+		if ((reiz_status < 200) || (reiz_status > 300) || hand_spiel ||
+			(i != spiel_allein))
+				return false;
+		size_t ei = par.find(" ");
+		if (ei == par.npos)
+			return false;
+		int tt1 = skat_wort2type(par.substr(0, ei));
+		int tt2 = skat_wort2type(par.substr(ei + 1, par.length() - (ei + 1)));
+		if ((tt1 == -1) || (tt2 == -1) || (tt1 == tt2))
+			return false;
+		skat_cardset_t sk = skat_card2set(tt1) | skat_card2set(tt2);
+		if ((hand[i] & sk) != sk)
+			return false;
+		hand[i] &= ~sk, skat = sk, reiz_status += 100;
+		broadcast(nicks[i] + " DRUECKE");
+		return true;
+	}
+	if ((word == "sagean") || (word == "announce"))
+	{
+		if (!((!hand_spiel && (reiz_status > 300) && (reiz_status < 400)) ||
+			(hand_spiel && (reiz_status > 200) && (reiz_status < 300))) ||
+			(i != spiel_allein) || (par == ""))
+				return false;
+		std::string spiel = par, zusatz = "";
+		size_t ei = par.find(" ");
+		if (ei != par.npos)
+		{
+			spiel = par.substr(0, ei);
+			zusatz = par.substr(ei + 1, par.length() - (ei + 1));
+		}
+		int s1 = skat_wort2spiel(spiel);
+		int s2 = skat_wort2spiel(zusatz);
+		int sz = s1 + s2 + (hand_spiel ? 1000 : 0);
+		if ((s1 == -1) || (s2 == -1) || (s1 <= 0) || (sz <= 0))
+			return false;
+		if (!(((sz < 100) || (sz > 1000) || (sz == 323)) && (sz != 1123) &&
+			(sz != 1223)))
+				return false;
+		reiz_status += (hand_spiel ? 200 : 100);
+		spiel_status = sz;
+		// Ouvert Spiele -- Karten oeffnen
+		if ((spiel_status - (hand_spiel ? 1000 : 0)) > 300)
+		{
+			std::vector<size_t> ov;
+			skat_cardset2vector(hand[i], ov);
+			for (size_t j = 0; j < ov.size(); j++)
+			{
+				std::ostringstream ost;
+				ost << nicks[i] << " OUVERT " << ov[j];
+				for (size_t k = 0; k < 3; k++)
+					if (k != i)
+						send(k, ost.str());
+			}
+		}
+		std::ostringstream ost;
+		ost << nicks[i] << " SAGEAN " << spiel_status;
+		broadcast(ost.str());
+		spiel_dran = 0;
+		spiel_who[0] = vh, spiel_who[1] = mh, spiel_who[2] = hh;
+		return true;
+	}
+	if ((word == "lege") || (word == "play"))
+	{
+		if ((spiel_status == 0) || (i != spiel_who[spiel_dran]))
+			return false;
+		int tt = skat_wort2type(par);
+		if ((tt == -1) || !(hand[i] & skat_card2set(tt)))
+			return false;
+		// Regelkontrolle, falls schon Karten gespielt sind
+		if ((stich.size() > 0) &&
+			!(skat_legal(stich[0], spiel_status, hand[i]) & skat_card2set(tt)))
+				return false;
+		std::ostringstream ost;
+		ost << nicks[i] << " LEGE " << tt;
+		broadcast(ost.str());
+		hand[i] &= ~skat_card2set(tt);
+		stich.push_back(tt);
+		if (stich.size() == 3)
+		{
+			int bk = skat_bstich(stich[0], stich[1], stich[2], spiel_status);
+			assert(bk != -1);
+			size_t winner = spiel_who[bk];
+			broadcast(nicks[winner] + " BSTICH");
+			tricks[winner]++;
+			augen[winner] += skat_pktwert[stich[0]] + skat_pktwert[stich[1]] +
+				skat_pktwert[stich[2]];
+			stich.clear();
+			spiel_who[0] = winner;
+			spiel_who[1] = (spiel_who[0] + 1) % 3;
+			spiel_who[2] = (spiel_who[0] + 2) % 3;
+			spiel_dran = 0;
+			// Null-Spiele ggf. sofort abbrechen
+			if ((skat_spiel2gwert(spiel_status) == 23) &&
+				(tricks[spiel_allein] != 0))
+			{
+				hand[0] = 0, hand[1] = 0, hand[2] = 0;
+			}
+		}
+		else
+			spiel_dran += 1;
+		return true;
+	}
+	return false;
+}
+
+// Spielwert ermitteln wie in skat_game
+void skat_sim::score
+	(skat_sim_result &result)
+{
+	size_t pkt_gegner = 0;
+	for (size_t i = 0; i < 3; i++)
+	{
+		if (i != spiel_allein)
+			pkt_gegner += augen[i];
+	}
+	size_t pkt_allein = 120 - pkt_gegner;
+	bool spiel_gewonnen = (pkt_allein > 60);
+	int spiel_wert = 0;
+	// Null Spiel?
+	if (skat_spiel2gwert(spiel_status) == 23)
+	{
+		spiel_gewonnen = (tricks[spiel_allein] == 0);
+		if (hand_spiel && (spiel_status > 1300))
+			spiel_wert = 59;
+		if (!hand_spiel && (spiel_status > 300))
+			spiel_wert = 46;
+		if (hand_spiel && !(spiel_status > 1300))
+			spiel_wert = 35;
+		if (!hand_spiel && !(spiel_status > 300))
+			spiel_wert = 23;
+	}
+	else
+	{
+		size_t spitzen = skat_spitzen(spiel_status, allein);
+		size_t gs = spiel_status, gstufen = 1;
+		// Hand (2)
+		if (gs > 1000)
+			gstufen++, gs -= 1000;
+		// Offen (3)
+		if (gs > 300)
+			gstufen++, gs -= 100;
+		// Schwarz angesagt (4)
+		if (gs > 200)
+		{
+			gstufen++, gs -= 100;
+			if (tricks[spiel_allein] != 10)
+				spiel_gewonnen = false;
+		}
+		// Schneider angesagt (5)
+		if (gs > 100)
+		{
+			gstufen++, gs -= 100;
+			if (pkt_gegner >= 31)
+				spiel_gewonnen = false;
+		}
+		// Schwarz gespielt (6)
+		if (tricks[spiel_allein] == 10)
+			gstufen++;
+		// Schneider gespielt (7)
+		if (pkt_gegner < 31)
+			gstufen++;
+		// (selbst) Schwarz gespielt (6)
+		if (tricks[spiel_allein] == 0)
+			gstufen++, spiel_gewonnen = false;
+		// (selbst) Schneider gespielt (7)
+		if (pkt_allein < 31)
+			gstufen++, spiel_gewonnen = false;
+		spiel_wert = (spitzen + gstufen) * skat_spiel2gwert(spiel_status);
+	}
+	if (skat_reizwert[reiz_counter] > (size_t)spiel_wert)
+	{
+		spiel_wert = 0;
+		while ((size_t)spiel_wert < skat_reizwert[reiz_counter])
+			spiel_wert += skat_spiel2gwert(spiel_status);
+		spiel_wert = -spiel_wert;
+		spiel_gewonnen = false;
+	}
+	else
+	{
+		// verlorene Spiele werden immer bestraft!
+		if (!spiel_gewonnen)
+			spiel_wert = -2 * spiel_wert;
+	}
+	if (spiel_gewonnen)
+		broadcast(nicks[spiel_allein] + " GEWONNEN");
+	else
+		broadcast(nicks[spiel_allein] + " VERLOREN");
+	pkt_sum[spiel_allein] += spiel_wert;
+	std::ostringstream ost;
+	ost << nicks[spiel_allein] << " PROTO " << nicks[spiel_allein] << "~" <<
+		spiel_wert << "~" << spiel_status << "~" << pkt_allein << "~" <<
+		skat_reizwert[reiz_counter] << "~" << games << "~";
+	broadcast(ost.str());
+	result.declarer = spiel_allein, result.spiel = spiel_status;
+	result.reizwert = skat_reizwert[reiz_counter], result.augen = pkt_allein;
+	result.wert = spiel_wert, result.gewonnen = spiel_gewonnen;
+}
+
+// ein Spiel; false, falls es abgebrochen wurde
+bool skat_sim::play
+	(skat_sim_result &result)
+{
+	start();
+	deal(random_state, false);
+	return game(result);
+}
+
+// das Spiel mit dem Blatt seed, wobei VH stets die erste Hand bekommt: der
+// Reihe nach drei Mal gespielt, hat jeder Spieler jede Hand einmal
+bool skat_sim::play
+	(skat_sim_result &result, const unsigned long long seed)
+{
+	unsigned long long state = seed;
+	start();
+	deal(state, true);
+	return game(result);
+}
+
+void skat_sim::start
+	()
+{
+	p = games % 3;
+	if (p == 0)
+		vh = 0, mh = 1, hh = 2;
+	if (p == 1)
+		vh = 2, mh = 0, hh = 1;
+	if (p == 2)
+		vh = 1, mh = 2, hh = 0;
+	reiz_status = 0, reiz_counter = 0, spiel_status = 0, spiel_allein = 0;
+	spiel_dran = 0, hand_spiel = false, allein = 0;
+	stich.clear();
+	for (size_t i = 0; i < 3; i++)
+		tricks[i] = 0, augen[i] = 0;
+}
+
+bool skat_sim::game
+	(skat_sim_result &result)
+{
+	result.declarer = 3, result.spiel = 0, result.reizwert = 0;
+	result.augen = 0, result.wert = 0, result.gewonnen = false;
+	for (size_t i = 0; i < 3; i++)
+	{
+		send(i, nicks[i] + " MISCHEN");
+		send(i, nicks[i] + " GEBEN");
+		std::vector<size_t> cv;
+		skat_cardset2vector(hand[i], cv);
+		for (size_t j = 0; j < cv.size(); j++)
+		{
+			std::ostringstream ost;
+			ost << nicks[i] << " KARTE " << cv[j];
+			send(i, ost.str());
+		}
+		std::ostringstream ost;
+		ost << nicks[i] << " START " << ((i + p) % 3);
+		send(i, ost.str());
+	}
+	size_t idle = 0;
+	bool ok = true;
+	while (!(spiel_status > 0) ||
+		(hand[0] != 0) || (hand[1] != 0) || (hand[2] != 0))
+	{
+		if (reiz_status == 11)
+		{
+			reiz_status += 100;
+			for (size_t i = 0; i < 3; i++)
+				send(i, nicks[i] + " RAMSCH");
+			break;
+		}
+		if ((reiz_status >= 12) && (reiz_status <= 14))
+		{
+			if (reiz_status == 12)
+				spiel_allein = vh;
+			if (reiz_status == 13)
+				spiel_allein = mh;
+			if (reiz_status == 14)
+				spiel_allein = hh;
+			reiz_status += 100;
+			allein = hand[spiel_allein] | skat;
+			broadcast(nicks[spiel_allein] + " SPIELT");
+		}
+		bool progress = false;
+		for (size_t i = 0; i < 3; i++)
+		{
+			// Spielende: die letzten Nachrichten kommen zusammen mit STOP an
+			if ((reiz_status == 11) || ((spiel_status > 0) &&
+				(hand[0] == 0) && (hand[1] == 0) && (hand[2] == 0)))
+					break;
+			std::vector<std::string> commands;
+			if (pending[i].length() > 0)
+				progress = true;
+			deliver(i, (idle > 0), commands);
+			for (size_t j = 0; j < commands.size(); j++)
+			{
+				if (command(i, commands[j]))
+					progress = true;
+			}
+		}
+		if (progress)
+			idle = 0;
+		else if (++idle > SKAT_SIM_RETRIES)
+		{
+			ok = false;
+			break;
+		}
+	}
+	for (size_t i = 0; i < 3; i++)
+		send(i, nicks[i] + " STOP");
+	if (ok && (spiel_status > 0))
+		score(result);
+	else
+	{
+		for (size_t i = 0; i < 3; i++)
+			send(i, nicks[i] + " NONE");
+	}
+	for (size_t i = 0; i < 3; i++)
+	{
+		std::vector<std::string> commands;
+		deliver(i, false, commands);
+	}
+	games++;
+	if (!ok)
+		aborted++;
+	return ok;
+}
+
+void skat_sim::done
+	()
+{
+	for (size_t i = 0; i < 3; i++)
+	{
+		std::vector<std::string> commands;
+		send(i, nicks[i] + " DONE");
+		deliver(i, false, commands);
+	}
+}
+
+skat_sim::~skat_sim
+	()
+{
+	for (size_t i = 0; i < 3; i++)
+	{
+		players[i]->output(std::cout);
+		delete output[i];
+	}
+}
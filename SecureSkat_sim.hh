@@ -0,0 +1,104 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_sim_HH
+	#define INCLUDED_SecureSkat_sim_HH
+
+	#include "SecureSkat_defs.hh"
+	#include "SecureSkat_rule.hh"
+	#include "SecureSkat_player.hh"
+
+	// number of retries (act with retry = true), before a game is aborted
+	// because the player in turn does not send a valid command
+	#define SKAT_SIM_RETRIES	3
+
+	unsigned long long skat_usec
+		();
+
+	struct skat_sim_result
+	{
+		size_t declarer;				// seat of the declarer, 3 = nobody bids
+		size_t spiel, reizwert, augen;
+		int wert;
+		bool gewonnen;
+	};
+
+	// Simulator of a table without cryptography: the course of skat_game
+	// (dealing as skat_geben, bidding, Skat, announcement, tricks and the
+	// scoring) with three players in the same process. The players get the
+	// same control messages as the programs started by SecureSkat and their
+	// commands are checked by the same rules. The deal is reproducible for a
+	// given seed; the position VH moves on with every game.
+	class skat_sim
+	{
+		private:
+			std::vector<skat_player*> players;
+			std::vector<std::string> nicks;
+			std::vector<std::string> pending;
+			std::vector<std::ostringstream*> output;
+			char buffer[3][65536];
+			unsigned long long random_state;
+			size_t p, vh, mh, hh;
+			size_t reiz_status, reiz_counter, spiel_status, spiel_allein;
+			size_t spiel_dran, spiel_who[3];
+			bool hand_spiel;
+			skat_cardset_t hand[3], skat, allein;
+			std::vector<size_t> stich;
+			size_t tricks[3], augen[3];
+
+			void deal
+				(unsigned long long &state, const bool duplicate);
+			void send
+				(const size_t i, const std::string &line);
+			void broadcast
+				(const std::string &line);
+			void deliver
+				(const size_t i, const bool retry,
+				std::vector<std::string> &commands);
+			bool command
+				(const size_t i, const std::string &msg);
+			bool bid
+				(const size_t i, const bool pass);
+			void score
+				(skat_sim_result &result);
+			void start
+				();
+			bool game
+				(skat_sim_result &result);
+
+		public:
+			size_t games, aborted;
+			long pkt_sum[3];
+			// number of decisions and time (in microseconds) for them
+			unsigned long long decisions[3], decision_usec[3];
+
+			skat_sim
+				(skat_player *p0, skat_player *p1, skat_player *p2,
+				const unsigned long long seed);
+			bool play
+				(skat_sim_result &result);
+			bool play
+				(skat_sim_result &result, const unsigned long long seed);
+			void done
+				();
+			~skat_sim
+				();
+	};
+#endif
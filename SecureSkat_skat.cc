@@ -484,7 +484,8 @@ int skat_child
 	}
 	
 	std::ostringstream ost;
-	ost << "PRIVMSG " << MAIN_CHANNEL_UNDERSCORE << nr << " :PORT " << gp_port << std::endl;
+	// MISCHEN: separate channels for shuffling in advance are supported
+	ost << "PRIVMSG " << MAIN_CHANNEL_UNDERSCORE << nr << " :PORT " << gp_port << " MISCHEN" << std::endl;
 	*out_pipe << ost.str() << std::flush;
 	std::cout << X << _("Table") << " " << nr << " " << _("with") << " '" <<
 		pkr.keys[0].name << "', '" <<
@@ -492,6 +493,7 @@ int skat_child
 		pkr.keys[2].name << "' " << _("ready") << "." << std::endl;
 	std::list<std::string> gp_rdport;
 	std::map<std::string, int> gp_ports;
+	size_t gp_mischen = 0;
 	while (gp_rdport.size() < 2)
 	{
 		char tmp[10001];
@@ -545,6 +547,8 @@ int skat_child
 				{
 					gp_rdport.push_back(nick);
 					gp_ports[nick] = atoi(port.c_str());
+					if (port.find(" MISCHEN") != port.npos)
+						gp_mischen++;
 				}
 			}
 		}
@@ -574,14 +578,77 @@ int skat_child
 			break;
 	}
 	skat_error(skat_alive(right_neighbor, left_neighbor), out_pipe, nr);
+	// second channels (same order) for shuffling during the games
+	int connect_mix = -1, accept_mix = -1;
+	iosecuresocketstream *left_mix = NULL, *right_mix = NULL;
+	if (gp_mischen == 2)
+	{
+		switch (pkr_self)
+		{
+			case 0:
+				error = skat_connect(pkr_self, 1, left_mix, connect_mix, gp_ports, vnicks, pkr);
+				skat_error(error, out_pipe, nr);
+				error = skat_accept(out_pipe, ipipe, nr, r, pkr_self, 2, right_mix, accept_mix, vnicks, pkr, gp_handle, neu, ipipe_readbuf, ipipe_readed);
+				skat_error(error, out_pipe, nr);
+				break;
+			case 1:
+				error = skat_accept(out_pipe, ipipe, nr, r, pkr_self, 0, right_mix, accept_mix, vnicks, pkr, gp_handle, neu, ipipe_readbuf, ipipe_readed);
+				skat_error(error, out_pipe, nr);
+				error = skat_connect(pkr_self, 2, left_mix, connect_mix, gp_ports, vnicks, pkr);
+				skat_error(error, out_pipe, nr);
+				break;
+			case 2:
+				error = skat_accept(out_pipe, ipipe, nr, r, pkr_self, 1, right_mix, accept_mix, vnicks, pkr, gp_handle, neu, ipipe_readbuf, ipipe_readed);
+				skat_error(error, out_pipe, nr);
+				error = skat_connect(pkr_self, 0, left_mix, connect_mix, gp_ports, vnicks, pkr);
+				skat_error(error, out_pipe, nr);
+				break;
+		}
+		skat_error(skat_alive(right_mix, left_mix), out_pipe, nr);
+	}
 	
 	if (neu)
 		*out_pipe << "PRIVMSG " << MAIN_CHANNEL << " :" << nr << "|3~" << vnicks[0] << ", " << vnicks[1] << ", " << vnicks[2] << "!" <<	std::endl << std::flush;
 	
 	// start gui or ai (control program)
 	int ctl_i = 0, ctl_o = 0;
-	bool pctl = false;
-	if (game_ctl != "")
+	bool pctl = false, ctl_sock = false;
+	struct stat ctl_stat;
+	if ((game_ctl != "") && (stat(game_ctl.c_str(), &ctl_stat) == 0) &&
+		S_ISSOCK(ctl_stat.st_mode))
+	{
+		// the control program is a server for many games (SecureSkat_ai)
+		struct sockaddr_un addr;
+		int ctl_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		strncpy(addr.sun_path, game_ctl.c_str(), sizeof(addr.sun_path) - 1);
+		if (ctl_fd < 0)
+			perror("skat_child (socket)");
+		else if (connect(ctl_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+		{
+			perror("skat_child (connect)");
+			close(ctl_fd);
+		}
+		else
+		{
+			pctl = true, ctl_sock = true;
+			ctl_i = ctl_fd, ctl_o = ctl_fd;
+			std::cout << X << _("Connect control process") << " (" <<
+				game_ctl << "): " << std::flush;
+			char buffer[1025];
+			memset(buffer, 0, sizeof(buffer));
+			ssize_t num = read(ctl_i, buffer, (sizeof(buffer) - 1));
+			if (num > 0)
+			{
+				buffer[num] = 0; // null-terminate string
+				std::cout << buffer << std::flush;
+			}
+			else
+				std::cout << "... " << _("failed!") << std::endl;
+		}
+	}
+	else if (game_ctl != "")
 	{
 		int pipe1fd[2], pipe2fd[2];
 		if ((pipe(pipe1fd) < 0) || (pipe(pipe2fd) < 0))
@@ -636,7 +703,8 @@ int skat_child
 			" :" << PACKAGE_STRING << std::endl << std::flush;
 	}
 	int exit_code = skat_game(nr, r, pkr_self, neu, opipe, ipipe, ctl_o, ctl_i,
-		gp_tmcg, pkr, sec, right_neighbor, left_neighbor, vnicks, hpipe, pctl,
+		gp_tmcg, pkr, sec, right_neighbor, left_neighbor, right_mix, left_mix,
+		vnicks, hpipe, pctl,
 		ipipe_readbuf, ipipe_readed, MAIN_CHANNEL, MAIN_CHANNEL_UNDERSCORE);
 	
 	// stop gui or ai (control program)
@@ -646,16 +714,27 @@ int skat_child
 			perror("skat_child (kill)");
 		waitpid(ctl_pid, NULL, 0);
 	}
+	else if (ctl_sock)
+	{
+		// the server releases the seat, if the connection is closed
+		if (close(ctl_i) < 0)
+			perror("skat_child (close)");
+	}
 	
 	if (neu)
 		*out_pipe << "PRIVMSG " << MAIN_CHANNEL << " :" << nr << "|0~" << r << "!" << std::endl << std::flush;
 	
 	// release the game
 	delete left_neighbor, delete right_neighbor;
+	delete left_mix, delete right_mix;
 	if (connect_handle > 0)
 		CloseHandle(connect_handle);
 	if (accept_handle > 0)
 		CloseHandle(accept_handle);
+	if (connect_mix > 0)
+		CloseHandle(connect_mix);
+	if (accept_mix > 0)
+		CloseHandle(accept_mix);
 	if (exit_code != 6)
 		*out_pipe << "PART " << MAIN_CHANNEL_UNDERSCORE << nr << std::endl << std::flush;
 	CloseHandle(gp_handle);
@@ -0,0 +1,434 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_tb.hh"
+
+#define SKAT_TB_ROWS		5
+#define SKAT_TB_CLASSES		320
+#define SKAT_TB_CARDS		((3 * SKAT_TB_MAXK) + 1)
+#define SKAT_TB_NONE		((uint64_t)-1)
+
+// types of games (Ei, Gr, Ro, Sc, Null, Grand), the kind of each type and
+// the type that represents a kind in the generated positions
+static const size_t tb_gwert[6] = { 9, 10, 11, 12, 23, 24 };
+static const size_t tb_kind_of[6] =
+	{ SKAT_TB_SUIT, SKAT_TB_SUIT, SKAT_TB_SUIT, SKAT_TB_SUIT,
+	SKAT_TB_NULL, SKAT_TB_GRAND };
+static const size_t tb_repr[SKAT_TB_KINDS] = { 3, 5, 4 };
+
+// for each type: the cards ordered by row (trump first) and rank, the
+// position and the row of a card in this order, its group (cards of the row
+// with equal points) and the position in the group, and the weight of the
+// group in the class of the row (mixed radix number of the remaining cards
+// of each group)
+static size_t tb_seq[6][32], tb_pos[6][32], tb_crow[6][32], tb_group[6][32];
+static size_t tb_gpos[6][32];
+static uint32_t tb_weight[6][32];
+
+// for each kind: rows, classes and groups of a row, and the counting tables
+// for the ranking of the classes of all rows (cnt[r][m] is the number of
+// classes of the rows r, r+1, ... with m cards altogether)
+static size_t tb_rows[SKAT_TB_KINDS], tb_nclass[SKAT_TB_KINDS][SKAT_TB_ROWS];
+static size_t tb_cap[SKAT_TB_KINDS][SKAT_TB_ROWS][8];
+static unsigned char tb_csize[SKAT_TB_KINDS][SKAT_TB_ROWS][SKAT_TB_CLASSES];
+static uint64_t tb_cnt[SKAT_TB_KINDS][SKAT_TB_ROWS + 1][SKAT_TB_CARDS];
+static uint32_t
+	tb_pre[SKAT_TB_KINDS][SKAT_TB_ROWS][SKAT_TB_CLASSES][SKAT_TB_CARDS];
+
+// multinomial coefficients for the ranking of the owner sequences
+static uint64_t tb_mult[SKAT_TB_MAXK + 1][SKAT_TB_MAXK + 1][SKAT_TB_MAXK + 1];
+
+static pthread_once_t tb_once = PTHREAD_ONCE_INIT;
+
+static void skat_tb_init
+	()
+{
+	uint64_t fac[SKAT_TB_CARDS];
+	fac[0] = 1;
+	for (size_t i = 1; i < SKAT_TB_CARDS; i++)
+		fac[i] = fac[i - 1] * i;
+	for (size_t a = 0; a <= SKAT_TB_MAXK; a++)
+		for (size_t b = 0; b <= SKAT_TB_MAXK; b++)
+			for (size_t c = 0; c <= SKAT_TB_MAXK; c++)
+				tb_mult[a][b][c] = fac[a + b + c] / (fac[a] * fac[b] * fac[c]);
+	const size_t order[SKAT_TB_ROWS] = { 4, 0, 1, 2, 3 };
+	for (size_t s = 0; s < 6; s++)
+	{
+		size_t spiel = tb_gwert[s], kind = tb_kind_of[s], n = 0, rows = 0;
+		for (size_t i = 0; i < SKAT_TB_ROWS; i++)
+		{
+			size_t byrank[18], cap[8], g = 0, gpos = 0, pts = 0;
+			bool first = true;
+			for (size_t k = 0; k < 18; k++)
+				byrank[k] = 99;
+			for (size_t c = 0; c < 32; c++)
+			{
+				if (skat_cardrow(spiel, c) == order[i])
+					byrank[skat_cardrank(spiel, c)] = c;
+			}
+			for (size_t k = 0; k < 8; k++)
+				cap[k] = 0;
+			for (size_t k = 0; k < 18; k++)
+			{
+				size_t c = byrank[k];
+				if (c == 99)
+					continue;
+				size_t p = (kind == SKAT_TB_NULL) ? 0 : skat_pktwert[c];
+				if (!first && (p != pts))
+					g++, gpos = 0;
+				first = false, pts = p;
+				tb_pos[s][c] = n, tb_seq[s][n++] = c;
+				tb_crow[s][c] = rows, tb_group[s][c] = g;
+				tb_gpos[s][c] = gpos++;
+				cap[g]++;
+			}
+			if (first)
+				continue; // empty row (trump suit)
+			uint32_t w[9];
+			w[0] = 1;
+			for (size_t k = 0; k <= g; k++)
+				w[k + 1] = w[k] * (cap[k] + 1);
+			for (size_t k = 0; k < 18; k++)
+			{
+				if (byrank[k] != 99)
+					tb_weight[s][byrank[k]] = w[tb_group[s][byrank[k]]];
+			}
+			if (s == tb_repr[kind])
+			{
+				for (size_t k = 0; k < 8; k++)
+					tb_cap[kind][rows][k] = cap[k];
+				tb_nclass[kind][rows] = w[g + 1];
+			}
+			rows++;
+		}
+		if (s == tb_repr[kind])
+			tb_rows[kind] = rows;
+	}
+	for (size_t kind = 0; kind < SKAT_TB_KINDS; kind++)
+	{
+		size_t rows = tb_rows[kind];
+		for (size_t r = 0; r < rows; r++)
+		{
+			for (size_t cl = 0; cl < tb_nclass[kind][r]; cl++)
+			{
+				size_t rest = cl, sz = 0;
+				for (size_t k = 0; k < 8; k++)
+				{
+					sz += rest % (tb_cap[kind][r][k] + 1);
+					rest /= (tb_cap[kind][r][k] + 1);
+				}
+				tb_csize[kind][r][cl] = sz;
+			}
+		}
+		for (size_t m = 0; m < SKAT_TB_CARDS; m++)
+			tb_cnt[kind][rows][m] = (m == 0) ? 1 : 0;
+		for (size_t r = rows; r-- > 0; )
+		{
+			for (size_t m = 0; m < SKAT_TB_CARDS; m++)
+			{
+				uint64_t sum = 0;
+				for (size_t cl = 0; cl < tb_nclass[kind][r]; cl++)
+				{
+					tb_pre[kind][r][cl][m] = sum;
+					if (tb_csize[kind][r][cl] <= m)
+						sum += tb_cnt[kind][r + 1][m - tb_csize[kind][r][cl]];
+				}
+				tb_cnt[kind][r][m] = sum;
+			}
+		}
+	}
+}
+
+static inline size_t skat_tb_type
+	(const size_t spiel)
+{
+	for (size_t s = 0; s < 6; s++)
+	{
+		if (skat_spiel2gwert(spiel) == tb_gwert[s])
+			return s;
+	}
+	return 99;
+}
+
+size_t skat_tb_kind
+	(
+		const size_t spiel
+	)
+{
+	size_t s = skat_tb_type(spiel);
+	return (s < 6) ? tb_kind_of[s] : 99;
+}
+
+uint64_t skat_tb_entries
+	(
+		const size_t kind, const size_t k
+	)
+{
+	pthread_once(&tb_once, skat_tb_init);
+	if ((kind >= SKAT_TB_KINDS) || (k < 1) || (k > SKAT_TB_MAXK))
+		return 0;
+	return tb_cnt[kind][0][3 * k] * tb_mult[k][k][k] * 3;
+}
+
+// index of a position at the beginning of a trick: rank of the classes of
+// all rows, rank of the owner sequence and the declarer (relative to lead)
+static uint64_t skat_tb_index
+	(const size_t s, const size_t declarer, const size_t lead,
+	const skat_cardset_t hand[3], size_t &k)
+{
+	size_t kind = tb_kind_of[s], n[3], cls[SKAT_TB_ROWS] = { 0, 0, 0, 0, 0 };
+	skat_cardset_t h[3];
+	h[0] = hand[lead % 3], h[1] = hand[(lead + 1) % 3];
+	h[2] = hand[(lead + 2) % 3];
+	k = skat_cardset_size(h[0]);
+	if ((k == 0) || (k > SKAT_TB_MAXK) || (skat_cardset_size(h[1]) != k) ||
+		(skat_cardset_size(h[2]) != k))
+	{
+		return SKAT_TB_NONE;
+	}
+	// remaining cards of each seat in the order of tb_seq
+	uint32_t q[3] = { 0, 0, 0 };
+	for (size_t o = 0; o < 3; o++)
+	{
+		for (skat_cardset_t rest = h[o]; rest; rest &= (rest - 1))
+		{
+			size_t c = __builtin_ctz(rest);
+			q[o] |= (uint32_t)1 << tb_pos[s][c];
+			cls[tb_crow[s][c]] += tb_weight[s][c];
+		}
+	}
+	n[0] = k, n[1] = k, n[2] = k;
+	uint64_t orank = 0, trank = 0;
+	for (uint32_t rest = q[0] | q[1] | q[2]; rest; rest &= (rest - 1))
+	{
+		uint32_t bit = rest & (~rest + 1);
+		size_t o = (q[0] & bit) ? 0 : ((q[1] & bit) ? 1 : 2);
+		if ((o > 0) && (n[0] > 0))
+			orank += tb_mult[n[0] - 1][n[1]][n[2]];
+		if ((o > 1) && (n[1] > 0))
+			orank += tb_mult[n[0]][n[1] - 1][n[2]];
+		n[o]--;
+	}
+	size_t rem = 3 * k;
+	for (size_t r = 0; r < tb_rows[kind]; r++)
+	{
+		trank += tb_pre[kind][r][cls[r]][rem];
+		rem -= tb_csize[kind][r][cls[r]];
+	}
+	return ((trank * tb_mult[k][k][k]) + orank) * 3 +
+		((declarer + 3 - (lead % 3)) % 3);
+}
+
+// a position (lead is seat 0) of the given index for the generator
+bool skat_tb_position
+	(
+		const size_t kind, const size_t k, const uint64_t index,
+		size_t &spiel, size_t &declarer, skat_cardset_t hand[3]
+	)
+{
+	if (index >= skat_tb_entries(kind, k))
+		return false;
+	size_t s = tb_repr[kind], cls[SKAT_TB_ROWS] = { 0, 0, 0, 0, 0 }, n[3];
+	uint64_t m = tb_mult[k][k][k], idx = index / 3;
+	uint64_t orank = idx % m, trank = idx / m;
+	spiel = tb_gwert[s], declarer = index % 3;
+	size_t rem = 3 * k;
+	for (size_t r = 0; r < tb_rows[kind]; r++)
+	{
+		for (size_t cl = 0; cl < tb_nclass[kind][r]; cl++)
+		{
+			size_t sz = tb_csize[kind][r][cl];
+			if (sz > rem)
+				continue;
+			uint64_t block = tb_cnt[kind][r + 1][rem - sz];
+			if (trank < block)
+			{
+				cls[r] = cl, rem -= sz;
+				break;
+			}
+			trank -= block;
+		}
+	}
+	n[0] = k, n[1] = k, n[2] = k;
+	hand[0] = 0, hand[1] = 0, hand[2] = 0;
+	for (size_t i = 0; i < 32; i++)
+	{
+		size_t c = tb_seq[s][i], r = tb_crow[s][c];
+		size_t cap = tb_cap[kind][r][tb_group[s][c]];
+		if (tb_gpos[s][c] >= ((cls[r] / tb_weight[s][c]) % (cap + 1)))
+			continue;
+		for (size_t o = 0; o < 3; o++)
+		{
+			if (n[o] == 0)
+				continue;
+			n[o]--;
+			if (orank < tb_mult[n[0]][n[1]][n[2]])
+			{
+				hand[o] |= skat_card2set(c);
+				break;
+			}
+			orank -= tb_mult[n[0]][n[1]][n[2]];
+			n[o]++;
+		}
+	}
+	return true;
+}
+
+skat_tablebase::skat_tablebase
+	(const std::string &file):
+		path(file), state(0), data(NULL), data_size(0), mapped(false)
+{
+	pthread_mutex_init(&mutex, NULL);
+	memset(&header, 0, sizeof(header));
+}
+
+bool skat_tablebase::check
+	(const unsigned char *mem, const size_t size)
+{
+	skat_tb_header h;
+	if ((mem == NULL) || (size < sizeof(h)))
+		return false;
+	memcpy(&h, mem, sizeof(h));
+	if (memcmp(h.magic, SKAT_TB_MAGIC, sizeof(h.magic)))
+		return false;
+	for (size_t kind = 0; kind < SKAT_TB_KINDS; kind++)
+	{
+		if (h.kmax[kind] > SKAT_TB_MAXK)
+			return false;
+		for (size_t k = 1; k <= h.kmax[kind]; k++)
+		{
+			if ((h.count[kind][k] != skat_tb_entries(kind, k)) ||
+				(h.offset[kind][k] > size) ||
+				(h.count[kind][k] > (size - h.offset[kind][k])))
+			{
+				return false;
+			}
+		}
+	}
+	header = h;
+	return true;
+}
+
+// memory mapping of the file (without reading it)
+bool skat_tablebase::map
+	()
+{
+	if (path.length() == 0)
+		return false;
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if ((fstat(fd, &st) < 0) || (st.st_size < (off_t)sizeof(skat_tb_header)))
+	{
+		close(fd);
+		return false;
+	}
+	void *mem = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED)
+	{
+		perror("skat_tablebase (mmap)");
+		return false;
+	}
+	if (!check((const unsigned char*)mem, st.st_size))
+	{
+		std::cerr << "skat_tablebase: " << path << " is not valid" << std::endl;
+		munmap(mem, st.st_size);
+		return false;
+	}
+	madvise(mem, st.st_size, MADV_RANDOM);
+	data = (const unsigned char*)mem, data_size = st.st_size, mapped = true;
+	return true;
+}
+
+// uses a table in memory instead of the file (e.g. while generating it)
+bool skat_tablebase::attach
+	(const unsigned char *mem, const size_t size)
+{
+	pthread_mutex_lock(&mutex);
+	if (mapped)
+		munmap((void*)data, data_size);
+	data = NULL, data_size = 0, mapped = false;
+	bool ok = check(mem, size);
+	if (ok)
+		data = mem, data_size = size;
+	__atomic_store_n(&state, (ok) ? 1 : -1, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&mutex);
+	return ok;
+}
+
+// returns the maximum number of cards per hand that can be looked up
+size_t skat_tablebase::limit
+	(const size_t spiel)
+{
+	if (__atomic_load_n(&state, __ATOMIC_ACQUIRE) == 0)
+	{
+		pthread_once(&tb_once, skat_tb_init);
+		pthread_mutex_lock(&mutex);
+		if (state == 0)
+			__atomic_store_n(&state, (map()) ? 1 : -1, __ATOMIC_RELEASE);
+		pthread_mutex_unlock(&mutex);
+	}
+	size_t kind = skat_tb_kind(spiel);
+	if ((state != 1) || (kind >= SKAT_TB_KINDS))
+		return 0;
+	return header.kmax[kind];
+}
+
+// returns the value of the position or -1, if it is not contained
+int skat_tablebase::lookup
+	(const size_t spiel, const size_t declarer, const size_t lead,
+	const skat_cardset_t hand[3]) const
+{
+	if (__atomic_load_n(&state, __ATOMIC_ACQUIRE) != 1)
+		return -1;
+	size_t s = skat_tb_type(spiel), k = 0;
+	if (s >= 6)
+		return -1;
+	uint64_t idx = skat_tb_index(s, declarer, lead, hand, k);
+	size_t kind = tb_kind_of[s];
+	if ((idx == SKAT_TB_NONE) || (k > header.kmax[kind]))
+		return -1;
+	return data[header.offset[kind][k] + idx];
+}
+
+skat_tablebase::~skat_tablebase
+	()
+{
+	if (mapped)
+		munmap((void*)data, data_size);
+	pthread_mutex_destroy(&mutex);
+}
+
+static std::string skat_tablebase_file
+	()
+{
+	const char *env = getenv("SECURESKAT_TABLEBASE");
+	return (env != NULL) ? env : SKAT_TABLEBASE;
+}
+
+static skat_tablebase skat_tb_default(skat_tablebase_file());
+
+skat_tablebase &skat_tablebase_default
+	()
+{
+	return skat_tb_default;
+}
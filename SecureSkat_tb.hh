@@ -0,0 +1,112 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_tb_HH
+	#define INCLUDED_SecureSkat_tb_HH
+
+	#include "SecureSkat_defs.hh"
+	#include "SecureSkat_rule.hh"
+
+	// kinds of games with their own part of the tablebase
+	#define SKAT_TB_SUIT		0
+	#define SKAT_TB_GRAND		1
+	#define SKAT_TB_NULL		2
+	#define SKAT_TB_KINDS		3
+
+	// maximum number of cards per hand (remaining tricks)
+	#define SKAT_TB_MAXK		4
+
+	#define SKAT_TB_MAGIC		"SSKATTB1"
+
+	#ifndef SKAT_TABLEBASE
+		#define SKAT_TABLEBASE	"SecureSkat.tb"
+	#endif
+
+	// file header; for each kind of game and each number k of cards per hand
+	// (1 <= k <= kmax) there is a section of one byte per position
+	struct skat_tb_header
+	{
+		char magic[8];
+		uint32_t kmax[SKAT_TB_KINDS];
+		uint32_t reserved;
+		uint64_t offset[SKAT_TB_KINDS][SKAT_TB_MAXK + 1];
+		uint64_t count[SKAT_TB_KINDS][SKAT_TB_MAXK + 1];
+	};
+
+	// Endgame tablebase: exact values of all positions at the beginning of a
+	// trick with at most kmax cards per hand. Positions are not indexed by the
+	// cards itself, but by an abstraction that preserves the value: for each
+	// row (trump, suits) the sequence of the owners of the remaining cards in
+	// the order of their rank and for each row the card points that are left
+	// (e.g. two of the cards 9, 8 and 7 or three of the four jacks). Seats are
+	// given relative to the player that leads. The value is the number of card
+	// points that the declarer takes in the remaining tricks or, for Null
+	// games, 1 if the declarer takes no trick and 0 otherwise.
+	// The file is mapped into memory when the first search needs it.
+	class skat_tablebase
+	{
+		private:
+			std::string path;
+			int state;						// 0 unknown, 1 ready, -1 missing
+			pthread_mutex_t mutex;
+			const unsigned char *data;
+			size_t data_size;
+			bool mapped;
+			skat_tb_header header;
+
+			bool check
+				(const unsigned char *mem, const size_t size);
+			bool map
+				();
+
+		public:
+			skat_tablebase
+				(const std::string &file);
+			bool attach
+				(const unsigned char *mem, const size_t size);
+			size_t limit
+				(const size_t spiel);
+			int lookup
+				(const size_t spiel, const size_t declarer, const size_t lead,
+				const skat_cardset_t hand[3]) const;
+			~skat_tablebase
+				();
+	};
+
+	// the default tablebase (environment SECURESKAT_TABLEBASE or installed)
+	skat_tablebase &skat_tablebase_default
+		();
+
+	size_t skat_tb_kind
+		(
+			const size_t spiel
+		);
+
+	uint64_t skat_tb_entries
+		(
+			const size_t kind, const size_t k
+		);
+
+	bool skat_tb_position
+		(
+			const size_t kind, const size_t k, const uint64_t index,
+			size_t &spiel, size_t &declarer, skat_cardset_t hand[3]
+		);
+#endif
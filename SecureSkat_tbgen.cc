@@ -0,0 +1,158 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+// Generator of the endgame tablebase: the positions with k cards per hand
+// are solved by searching the first trick, the remaining tricks are taken
+// from the already generated part with k - 1 cards per hand.
+
+#include "SecureSkat_defs.hh"
+#include "SecureSkat_rule.hh"
+#include "SecureSkat_search.hh"
+#include "SecureSkat_pool.hh"
+#include "SecureSkat_tb.hh"
+
+#define SKAT_TBGEN_CHUNK	4096
+
+struct tbgen_job
+{
+	unsigned char *out;
+	size_t kind, k;
+	uint64_t first, count;
+	std::vector<skat_solver*> *solver;
+};
+
+void tbgen_solve
+	(void *arg, const size_t worker)
+{
+	tbgen_job *j = (tbgen_job*)arg;
+	skat_solver *s = (*j->solver)[worker];
+	for (uint64_t i = j->first; i < (j->first + j->count); i++)
+	{
+		skat_position p;
+		skat_cardset_t hand[3];
+		size_t spiel = 0, declarer = 0;
+		if (!skat_tb_position(j->kind, j->k, i, spiel, declarer, hand))
+			continue;
+		skat_position_init(p, spiel, declarer, 0);
+		p.hand[0] = hand[0], p.hand[1] = hand[1], p.hand[2] = hand[2];
+		j->out[i] = s->value(p);
+	}
+}
+
+int main (int argc, char **argv)
+{
+	const char *kind_name[SKAT_TB_KINDS] = { "Farbspiel", "Grand", "Null" };
+	std::string file = "SecureSkat.tb";
+	size_t kmax[SKAT_TB_KINDS] = { 2, 2, 3 };
+	if (argc > 1)
+		file = argv[1];
+	if (argc > 2)
+		kmax[SKAT_TB_SUIT] = strtoul(argv[2], NULL, 10);
+	if (argc > 3)
+		kmax[SKAT_TB_NULL] = strtoul(argv[3], NULL, 10);
+	kmax[SKAT_TB_SUIT] = std::min(kmax[SKAT_TB_SUIT], (size_t)SKAT_TB_MAXK);
+	kmax[SKAT_TB_GRAND] = kmax[SKAT_TB_SUIT];
+	kmax[SKAT_TB_NULL] = std::min(kmax[SKAT_TB_NULL], (size_t)SKAT_TB_MAXK);
+
+	// layout of the file
+	skat_tb_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SKAT_TB_MAGIC, sizeof(header.magic));
+	uint64_t size = (sizeof(header) + 63) & ~(uint64_t)63;
+	for (size_t kind = 0; kind < SKAT_TB_KINDS; kind++)
+	{
+		for (size_t k = 1; k <= kmax[kind]; k++)
+		{
+			header.offset[kind][k] = size;
+			header.count[kind][k] = skat_tb_entries(kind, k);
+			size += header.count[kind][k];
+		}
+	}
+	unsigned char *table = (unsigned char*)calloc(size, 1);
+	if (table == NULL)
+	{
+		perror("SecureSkat_tbgen (calloc)");
+		return EXIT_FAILURE;
+	}
+	memcpy(table, &header, sizeof(header));
+
+	// the solvers use the part of the table generated so far
+	skat_tablebase tb("");
+	skat_pool pool;
+	std::vector<skat_solver*> solver;
+	tb.attach(table, size);
+	for (size_t i = 0; i < pool.size(); i++)
+	{
+		solver.push_back(new skat_solver(16));
+		solver[i]->tablebase(&tb);
+	}
+	for (size_t kind = 0; kind < SKAT_TB_KINDS; kind++)
+	{
+		for (size_t k = 1; k <= kmax[kind]; k++)
+		{
+			unsigned long long start = skat_msec();
+			uint64_t n = header.count[kind][k];
+			std::vector<tbgen_job> jobs;
+			for (uint64_t i = 0; i < n; i += SKAT_TBGEN_CHUNK)
+			{
+				tbgen_job j;
+				j.out = table + header.offset[kind][k], j.kind = kind, j.k = k;
+				j.first = i, j.count = std::min((uint64_t)SKAT_TBGEN_CHUNK, n - i);
+				j.solver = &solver;
+				jobs.push_back(j);
+			}
+			for (size_t i = 0; i < jobs.size(); i++)
+				pool.submit(tbgen_solve, &jobs[i]);
+			pool.wait();
+			header.kmax[kind] = k;
+			memcpy(table, &header, sizeof(header));
+			tb.attach(table, size);
+			std::cerr << "SecureSkat_tbgen: " << kind_name[kind] << " with " <<
+				k << " cards: " << n << " positions in " <<
+				(skat_msec() - start) << " ms" << std::endl;
+		}
+	}
+	for (size_t i = 0; i < solver.size(); i++)
+		delete solver[i];
+
+	// write a temporary file and rename it, thus the table is never partial
+	std::string tmp = file + ".tmp";
+	FILE *f = fopen(tmp.c_str(), "wb");
+	if (f == NULL)
+	{
+		perror("SecureSkat_tbgen (fopen)");
+		free(table);
+		return EXIT_FAILURE;
+	}
+	if ((fwrite(table, 1, size, f) != size) || fclose(f))
+	{
+		perror("SecureSkat_tbgen (fwrite)");
+		unlink(tmp.c_str());
+		free(table);
+		return EXIT_FAILURE;
+	}
+	free(table);
+	if (rename(tmp.c_str(), file.c_str()) < 0)
+	{
+		perror("SecureSkat_tbgen (rename)");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
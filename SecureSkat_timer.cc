@@ -0,0 +1,72 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#include "SecureSkat_timer.hh"
+
+skat_timer::skat_timer
+	(const unsigned long long game_budget):
+		min_time(50), max_time(10000)
+{
+	share[SKAT_TIMER_REIZEN] = 20;
+	share[SKAT_TIMER_DRUECKEN] = 15;
+	share[SKAT_TIMER_STICHE] = 65;
+	reset(game_budget);
+}
+
+void skat_timer::reset
+	(const unsigned long long game_budget)
+{
+	budget = game_budget, used = 0, started = 0, phase = 0;
+	phase_used[0] = 0, phase_used[1] = 0, phase_used[2] = 0;
+}
+
+// returns the deadline for a decision in phase p, where the decisions left
+// in this phase (including the current one) have weight 1 except the
+// current one; a weight of 0 means that there is nothing to think about
+unsigned long long skat_timer::start
+	(const size_t p, const size_t decisions, const size_t weight)
+{
+	size_t pshare = 0;
+	phase = (p < 3) ? p : SKAT_TIMER_STICHE;
+	for (size_t i = 0; i <= phase; i++)
+		pshare += share[i];
+	unsigned long long avail = (budget * pshare) / 100, t = 0;
+	avail = (avail > used) ? (avail - used) : 0;
+	if ((decisions > 0) && (weight > 0))
+		t = (avail * weight) / (decisions - 1 + weight);
+	t = std::min(std::max(t, min_time), max_time);
+	started = skat_msec();
+	return started + t;
+}
+
+void skat_timer::stop
+	()
+{
+	if (started == 0)
+		return;
+	unsigned long long t = skat_msec() - started;
+	used += t, phase_used[phase] += t, started = 0;
+}
+
+unsigned long long skat_timer::remaining
+	() const
+{
+	return (budget > used) ? (budget - used) : 0;
+}
@@ -0,0 +1,58 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+#ifndef INCLUDED_SecureSkat_timer_HH
+	#define INCLUDED_SecureSkat_timer_HH
+
+	#include "SecureSkat_defs.hh"
+	#include "SecureSkat_search.hh"
+
+	// phases of a game
+	#define SKAT_TIMER_REIZEN		0
+	#define SKAT_TIMER_DRUECKEN		1
+	#define SKAT_TIMER_STICHE		2
+
+	// time management: the thinking time of a game (budget) is divided into
+	// shares of the phases, unused time is carried over to the next phases
+	// and within a phase each decision gets a part according to its weight
+	class skat_timer
+	{
+		private:
+			unsigned long long budget, used, started;
+			size_t phase;
+
+		public:
+			size_t share[3];						// percent of the budget
+			unsigned long long min_time, max_time;	// limits for a decision
+			unsigned long long phase_used[3];
+
+			skat_timer
+				(const unsigned long long game_budget);
+			void reset
+				(const unsigned long long game_budget);
+			unsigned long long start
+				(const size_t p, const size_t decisions,
+				const size_t weight = 1);
+			void stop
+				();
+			unsigned long long remaining
+				() const;
+	};
+#endif
@@ -0,0 +1,281 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+// Tournament of computer players: the deals are played at several tables in
+// parallel, each deal three times such that every player gets each hand
+// once (duplicate). The report contains the won games, the score points of
+// the extended Seeger system (as /rank of SecureSkat) with 95% confidence
+// intervals, the throughput and the mean time for a decision.
+// usage: SecureSkat_tournament [deals] [seed] [player0] [player1] [player2]
+// with the players "random", "ai" or "ai:engine" (pimc, ismcts, heuristik);
+// the number of tables is given by environment SECURESKAT_TABLES; with
+// environment SECURESKAT_CHECK the tournament fails, if the bidding is out
+// of the range of real play (regression check of the bid calibration by
+// self-play of ai:heuristik with the learned model)
+
+#include "SecureSkat_defs.hh"
+#include "SecureSkat_pool.hh"
+#include "SecureSkat_player.hh"
+#include "SecureSkat_aiplayer.hh"
+#include "SecureSkat_sim.hh"
+
+// bounds of the regression check: share of games without bid and winning
+// rate of the declarers (in percent)
+#define TOURNAMENT_MAX_PASS		30
+#define TOURNAMENT_MIN_WON		60
+#define TOURNAMENT_MAX_WON		85
+
+struct tournament_stats
+{
+	unsigned long long games, none, aborted;
+	unsigned long long declared[3], won[3], lost[3];
+	long pkt[3];
+	// Seeger points per deal (sum and sum of squares for the variance)
+	double seeger[3], seeger2[3];
+	unsigned long long decisions[3], decision_usec[3];
+};
+
+struct tournament_table
+{
+	std::string *spec;
+	size_t id;
+	unsigned long long seed, deals, *next;
+	unsigned long long bedenkzeit, spielzeit;
+	bool failed;
+	tournament_stats stats;
+};
+
+skat_player *tournament_player
+	(const std::string &spec, const unsigned long long seed, skat_pool &pool,
+	std::ostream &dbg, const unsigned long long bedenkzeit,
+	const unsigned long long spielzeit)
+{
+	if (spec == "random")
+		return new skat_random_player(std::cout, seed);
+	if ((spec == "ai") || (spec.find("ai:") == 0))
+	{
+		std::string engine = (spec == "ai") ? "pimc" : spec.substr(3);
+		skat_ai_player *ai = new skat_ai_player(std::cout, seed, pool,
+			engine, bedenkzeit, spielzeit);
+		ai->debug(dbg);
+		return ai;
+	}
+	return NULL;
+}
+
+// one table: the players search with their own single thread, thus there
+// are as many busy threads as tables
+void tournament_play
+	(void *arg, const size_t)
+{
+	tournament_table *t = (tournament_table*)arg;
+	skat_pool pool(1);
+	std::ostream nirvana(NULL);
+	skat_player *player[3] = { NULL, NULL, NULL };
+	for (size_t i = 0; i < 3; i++)
+	{
+		player[i] = tournament_player(t->spec[i], t->seed + (3 * t->id) + i + 1,
+			pool, nirvana, t->bedenkzeit, t->spielzeit);
+		if (player[i] == NULL)
+			t->failed = true;
+	}
+	if (!t->failed)
+	{
+		skat_sim sim(player[0], player[1], player[2], t->seed + t->id);
+		tournament_stats &st = t->stats;
+		unsigned long long d;
+		while ((d = __sync_fetch_and_add(t->next, 1ULL)) < t->deals)
+		{
+			unsigned long long ds = t->seed + d;
+			unsigned long long deal = skat_splitmix(ds);
+			double seeger[3] = { 0.0, 0.0, 0.0 };
+			for (size_t k = 0; k < 3; k++)
+			{
+				skat_sim_result r;
+				st.games++;
+				if (!sim.play(r, deal))
+				{
+					st.aborted++;
+					continue;
+				}
+				if (r.declarer > 2)
+				{
+					st.none++;
+					continue;
+				}
+				// erweitertes Seeger-System: Spielwert, 50 Punkte je gewonnenes
+				// (abzueglich verlorenes) Spiel, 40 Punkte fuer die Gegner
+				st.declared[r.declarer]++, st.pkt[r.declarer] += r.wert;
+				seeger[r.declarer] += r.wert;
+				if (r.wert > 0)
+				{
+					st.won[r.declarer]++;
+					seeger[r.declarer] += 50;
+				}
+				else
+				{
+					st.lost[r.declarer]++;
+					seeger[r.declarer] -= 50;
+					for (size_t i = 0; i < 3; i++)
+						if (i != r.declarer)
+							seeger[i] += 40;
+				}
+			}
+			for (size_t i = 0; i < 3; i++)
+			{
+				st.seeger[i] += seeger[i];
+				st.seeger2[i] += seeger[i] * seeger[i];
+			}
+		}
+		sim.done();
+		for (size_t i = 0; i < 3; i++)
+		{
+			st.decisions[i] += sim.decisions[i];
+			st.decision_usec[i] += sim.decision_usec[i];
+		}
+	}
+	for (size_t i = 0; i < 3; i++)
+		delete player[i];
+}
+
+int main (int argc, char **argv)
+{
+	unsigned long long deals = 1000, seed = 0, next = 0;
+	std::string spec[3] = { "ai", "ai:heuristik", "ai:heuristik" };
+	if (argc > 1)
+		deals = strtoull(argv[1], NULL, 10);
+	if (argc > 2)
+		seed = strtoull(argv[2], NULL, 10);
+	for (size_t i = 0; (i < 3) && ((int)i < (argc - 3)); i++)
+		spec[i] = argv[3 + i];
+
+	// initialize LibTMCG (random numbers of the search engines)
+	if (!init_libTMCG())
+	{
+		std::cerr << "Initialization of LibTMCG failed!" << std::endl;
+		return EXIT_FAILURE;
+	}
+	// Bedenkzeit und Spielzeit wie bei SecureSkat_ai, Anzahl der Tische
+	unsigned long long bedenkzeit = 0, spielzeit = SKAT_GAME_TIME;
+	if (getenv("SECURESKAT_BEDENKZEIT") != NULL)
+		bedenkzeit = strtoul(getenv("SECURESKAT_BEDENKZEIT"), NULL, 10);
+	if (getenv("SECURESKAT_SPIELZEIT") != NULL)
+		spielzeit = strtoul(getenv("SECURESKAT_SPIELZEIT"), NULL, 10);
+	size_t tables = skat_pool_cpus();
+	if (getenv("SECURESKAT_TABLES") != NULL)
+		tables = strtoul(getenv("SECURESKAT_TABLES"), NULL, 10);
+	if (tables == 0)
+		tables = 1;
+
+	skat_pool pool(tables);
+	std::vector<tournament_table> table(tables);
+	unsigned long long start = skat_msec();
+	for (size_t w = 0; w < tables; w++)
+	{
+		tournament_table &t = table[w];
+		memset(&t.stats, 0, sizeof(t.stats));
+		t.spec = spec, t.id = w, t.seed = seed, t.deals = deals, t.next = &next;
+		t.bedenkzeit = bedenkzeit, t.spielzeit = spielzeit, t.failed = false;
+		pool.submit(tournament_play, &t, w);
+	}
+	pool.wait();
+	unsigned long long ms = skat_msec() - start;
+
+	tournament_stats st;
+	memset(&st, 0, sizeof(st));
+	for (size_t w = 0; w < tables; w++)
+	{
+		const tournament_stats &ts = table[w].stats;
+		if (table[w].failed)
+		{
+			std::cerr << "SecureSkat_tournament: unknown player" << std::endl;
+			return EXIT_FAILURE;
+		}
+		st.games += ts.games, st.none += ts.none, st.aborted += ts.aborted;
+		for (size_t i = 0; i < 3; i++)
+		{
+			st.declared[i] += ts.declared[i], st.won[i] += ts.won[i];
+			st.lost[i] += ts.lost[i], st.pkt[i] += ts.pkt[i];
+			st.seeger[i] += ts.seeger[i], st.seeger2[i] += ts.seeger2[i];
+			st.decisions[i] += ts.decisions[i];
+			st.decision_usec[i] += ts.decision_usec[i];
+		}
+	}
+
+	std::cout << "deals: " << deals << ", games: " << st.games << " (" <<
+		st.none << " without bid, " << st.aborted << " aborted) at " <<
+		tables << " tables in " << ms << " ms = " <<
+		((1000.0 * st.games) / ((ms > 0) ? ms : 1)) << " games/s" << std::endl;
+	for (size_t i = 0; i < 3; i++)
+	{
+		// won games of the declarer (normal approximation)
+		double n = st.declared[i], q = 0.0, dq = 0.0;
+		if (n > 0)
+		{
+			q = st.won[i] / n;
+			dq = 1.96 * sqrt(q * (1.0 - q) / n);
+		}
+		// Seeger points as /rank (50 points only for more won than lost games)
+		// and the mean per game with the deal as independent sample
+		long seeger = st.pkt[i];
+		if (st.won[i] > st.lost[i])
+			seeger += 50 * (st.won[i] - st.lost[i]);
+		for (size_t j = 0; j < 3; j++)
+			if (j != i)
+				seeger += 40 * st.lost[j];
+		double mean = 0.0, dmean = 0.0;
+		if (deals > 0)
+		{
+			mean = st.seeger[i] / deals;
+			double var = (st.seeger2[i] / deals) - (mean * mean);
+			if (deals > 1)
+				dmean = 1.96 * sqrt(std::max(var, 0.0) / (deals - 1));
+		}
+		std::cout << "player " << i << " (" << spec[i] << "): " <<
+			st.declared[i] << " games, " << st.won[i] << " won (" <<
+			(100.0 * q) << "% +- " << (100.0 * dq) << "%), " << st.pkt[i] <<
+			" points, Seeger " << seeger << " (" << (mean / 3.0) << " +- " <<
+			(dmean / 3.0) << " per game), " << st.decisions[i] <<
+			" decisions in " << ((st.decisions[i] > 0) ?
+				((st.decision_usec[i] / 1000.0) / st.decisions[i]) : 0.0) <<
+			" ms" << std::endl;
+	}
+	// bidding of all players: games without bid and won games of declarers
+	unsigned long long played = st.games - st.aborted, declared = 0, won = 0;
+	for (size_t i = 0; i < 3; i++)
+		declared += st.declared[i], won += st.won[i];
+	double pass = (played > 0) ? ((100.0 * st.none) / played) : 0.0;
+	double quote = (declared > 0) ? ((100.0 * won) / declared) : 0.0;
+	std::cout << "bidding: " << pass << "% without bid, declarers won " <<
+		quote << "%" << std::endl;
+	if (getenv("SECURESKAT_CHECK") != NULL)
+	{
+		if ((pass > TOURNAMENT_MAX_PASS) || (quote < TOURNAMENT_MIN_WON) ||
+			(quote > TOURNAMENT_MAX_WON))
+		{
+			std::cerr << "SecureSkat_tournament: bidding out of range (at most " <<
+				TOURNAMENT_MAX_PASS << "% without bid, declarers win " <<
+				TOURNAMENT_MIN_WON << "% to " << TOURNAMENT_MAX_WON << "%)" <<
+				std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,216 @@
+/*******************************************************************************
+   This file is part of SecureSkat.
+
+ Copyright (C) 2019  Heiko Stamer <HeikoStamer@gmx.net>
+
+   SecureSkat is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   SecureSkat is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with SecureSkat; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+*******************************************************************************/
+
+// Training of the learned evaluation (skat_model): random deals are played
+// out by the double-dummy solver for the declarer's longest suit, Grand and
+// Null, each as hand game and with the skat (put away by skat_eval_druecken
+// as the simulation of skat_eval does). The weights of the logistic
+// regression are fitted by stochastic gradient descent on 90% of the deals,
+// the remaining deals are used to report the accuracy of the model.
+// usage: SecureSkat_train [file] [deals] [seed]
+
+#include "SecureSkat_defs.hh"
+#include "SecureSkat_rule.hh"
+#include "SecureSkat_search.hh"
+#include "SecureSkat_pool.hh"
+#include "SecureSkat_player.hh"
+#include "SecureSkat_learn.hh"
+
+#define SKAT_TRAIN_CHUNK	16
+#define SKAT_TRAIN_EPOCHS	40
+#define SKAT_TRAIN_RATE		0.1f
+#define SKAT_TRAIN_L2		0.0001f
+
+// one sample per deal, kind (longest suit, Grand, Null) and mode
+#define SKAT_TRAIN_SAMPLES	(SKAT_LEARN_KINDS * SKAT_LEARN_MODES)
+
+struct train_sample
+{
+	float x[SKAT_LEARN_FEATURES] __attribute__((aligned(32)));
+	float y;
+};
+
+struct train_job
+{
+	unsigned long long seed, first, count;
+	std::vector<train_sample> *samples;
+	std::vector<skat_solver*> *solver;
+};
+
+void train_solve
+	(void *arg, const size_t worker)
+{
+	train_job *j = (train_job*)arg;
+	skat_solver *s = (*j->solver)[worker];
+	for (unsigned long long d = j->first; d < (j->first + j->count); d++)
+	{
+		// deal: seat 0 is the declarer at position pos (0 = Vorhand)
+		unsigned long long state = j->seed + d;
+		size_t cv[32];
+		for (size_t c = 0; c < 32; c++)
+			cv[c] = c;
+		for (size_t k = 32; k > 1; k--)
+			std::swap(cv[k - 1], cv[skat_splitmix(state) % k]);
+		skat_cardset_t h[4] = { 0, 0, 0, 0 };
+		for (size_t k = 0; k < 32; k++)
+			h[(k < 30) ? (k / 10) : 3] |= skat_card2set(cv[k]);
+		size_t pos = d % 3, lead = (3 - pos) % 3;
+		// the suit game with the most trumps
+		size_t spiele[SKAT_LEARN_KINDS] = { 9, 24, 23 };
+		for (size_t sp = 10; sp <= 12; sp++)
+		{
+			if (skat_cardset_size(h[0] & skat_trumpmask(sp)) >=
+				skat_cardset_size(h[0] & skat_trumpmask(spiele[0])))
+					spiele[0] = sp;
+		}
+		for (size_t kind = 0; kind < SKAT_LEARN_KINDS; kind++)
+		{
+			size_t spiel = spiele[kind];
+			train_sample *ts = &(*j->samples)[(d * SKAT_TRAIN_SAMPLES) +
+				(kind * SKAT_LEARN_MODES)];
+			skat_position p;
+			// hand game: the skat counts for the declarer
+			skat_position_init(p, spiel, 0, lead);
+			p.hand[0] = h[0], p.hand[1] = h[1], p.hand[2] = h[2];
+			p.augen = skat_augen(h[3]);
+			skat_learn_features(spiel, SKAT_LEARN_HAND, h[0], pos,
+				ts[SKAT_LEARN_HAND].x);
+			ts[SKAT_LEARN_HAND].y = (s->wins(p)) ? 1.0f : 0.0f;
+			// the skat is taken: one result for 10 cards before and 12 cards
+			// after taking it
+			skat_cardset_t all = h[0] | h[3], dr = skat_eval_druecken(spiel, all);
+			skat_position_init(p, spiel, 0, lead);
+			p.hand[0] = all & ~dr, p.hand[1] = h[1], p.hand[2] = h[2];
+			p.augen = skat_augen(dr);
+			skat_learn_features(spiel, SKAT_LEARN_SKAT, h[0], pos,
+				ts[SKAT_LEARN_SKAT].x);
+			skat_learn_features(spiel, SKAT_LEARN_TAKEN, all, pos,
+				ts[SKAT_LEARN_TAKEN].x);
+			ts[SKAT_LEARN_SKAT].y = (s->wins(p)) ? 1.0f : 0.0f;
+			ts[SKAT_LEARN_TAKEN].y = ts[SKAT_LEARN_SKAT].y;
+		}
+	}
+}
+
+int main (int argc, char **argv)
+{
+	const char *kind_name[SKAT_LEARN_KINDS] = { "Farbspiel", "Grand", "Null" };
+	const char *mode_name[SKAT_LEARN_MODES] = { "Skat", "Hand", "gedrueckt" };
+	std::string file = "SecureSkat.model";
+	unsigned long long deals = 20000, seed = 0;
+	if (argc > 1)
+		file = argv[1];
+	if (argc > 2)
+		deals = strtoull(argv[2], NULL, 10);
+	if (argc > 3)
+		seed = strtoull(argv[3], NULL, 10);
+	if (deals < 10)
+		deals = 10;
+
+	// solve the deals in parallel
+	unsigned long long start = skat_msec();
+	std::vector<train_sample> samples(deals * SKAT_TRAIN_SAMPLES);
+	skat_pool pool;
+	std::vector<skat_solver*> solver;
+	for (size_t i = 0; i < pool.size(); i++)
+		solver.push_back(new skat_solver());
+	std::vector<train_job> jobs;
+	for (unsigned long long d = 0; d < deals; d += SKAT_TRAIN_CHUNK)
+	{
+		train_job j;
+		j.seed = seed, j.first = d;
+		j.count = std::min((unsigned long long)SKAT_TRAIN_CHUNK, deals - d);
+		j.samples = &samples, j.solver = &solver;
+		jobs.push_back(j);
+	}
+	for (size_t i = 0; i < jobs.size(); i++)
+		pool.submit(train_solve, &jobs[i]);
+	pool.wait();
+	for (size_t i = 0; i < solver.size(); i++)
+		delete solver[i];
+	std::cerr << "SecureSkat_train: " << deals << " deals solved in " <<
+		(skat_msec() - start) << " ms" << std::endl;
+
+	// logistic regression for each kind and mode
+	skat_model model;
+	unsigned long long train = (deals * 9) / 10;
+	std::vector<unsigned long long> order(train);
+	for (unsigned long long d = 0; d < train; d++)
+		order[d] = d;
+	for (size_t kind = 0; kind < SKAT_LEARN_KINDS; kind++)
+	{
+		for (size_t mode = 0; mode < SKAT_LEARN_MODES; mode++)
+		{
+			size_t off = (kind * SKAT_LEARN_MODES) + mode;
+			float *w = model.w(kind, mode);
+			unsigned long long state = seed ^ off;
+			for (size_t e = 0; e < SKAT_TRAIN_EPOCHS; e++)
+			{
+				float rate = SKAT_TRAIN_RATE / (1.0f + e);
+				for (unsigned long long k = train; k > 1; k--)
+					std::swap(order[k - 1], order[skat_splitmix(state) % k]);
+				for (unsigned long long k = 0; k < train; k++)
+				{
+					const train_sample &ts =
+						samples[(order[k] * SKAT_TRAIN_SAMPLES) + off];
+					float p = 0.0f, g = 0.0f;
+					model.predict(kind, mode, ts.x, 1, &p);
+					g = p - ts.y;
+					for (size_t f = 0; f < SKAT_LEARN_FEATURES; f++)
+						w[f] -= rate * ((g * ts.x[f]) + (SKAT_TRAIN_L2 * w[f]));
+				}
+			}
+			// accuracy and mean log loss on the remaining deals
+			size_t right = 0, won = 0, n = 0;
+			double loss = 0.0;
+			for (unsigned long long d = train; d < deals; d++, n++)
+			{
+				const train_sample &ts = samples[(d * SKAT_TRAIN_SAMPLES) + off];
+				float p = 0.0f;
+				model.predict(kind, mode, ts.x, 1, &p);
+				p = std::min(std::max(p, 0.0001f), 0.9999f);
+				if ((p >= 0.5f) == (ts.y > 0.5f))
+					right++;
+				if (ts.y > 0.5f)
+					won++;
+				loss -= (ts.y > 0.5f) ? log(p) : log(1.0f - p);
+			}
+			std::cerr << "SecureSkat_train: " << kind_name[kind] << " (" <<
+				mode_name[mode] << "): " << won << " of " << n << " won, " <<
+				right << " predicted, log loss " << (loss / n) << std::endl;
+		}
+	}
+
+	// write a temporary file and rename it, thus the model is never partial
+	std::string tmp = file + ".tmp";
+	if (!model.save(tmp))
+	{
+		std::cerr << "SecureSkat_train: writing " << tmp << " failed" <<
+			std::endl;
+		unlink(tmp.c_str());
+		return EXIT_FAILURE;
+	}
+	if (rename(tmp.c_str(), file.c_str()) < 0)
+	{
+		perror("SecureSkat_train (rename)");
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
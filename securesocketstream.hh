@@ -196,6 +196,14 @@ template <class traits = securesocketbuf_traits>
 			gcry_cipher_close(chd_out);
 			delete [] mRBuffer, delete [] mWBuffer;
 		}
+		
+		/*! @method handle
+		 * @return the socket of this buffer
+		 */
+		int handle() const
+		{
+			return mSocket;
+		}
 	
 	protected:
 		/*! @method flushOutput
@@ -450,6 +458,14 @@ class iosecuresocketstream : public std::iostream
 				std::iostream(&buf), buf(iSocket, key_in, size_in, key_out, size_out)
 		{
 		}
+		
+		/*! @method handle
+		 * @return the socket of this stream
+		 */
+		int handle() const
+		{
+			return buf.handle();
+		}
 };
 
 #endif